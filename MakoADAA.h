@@ -0,0 +1,257 @@
+/*
+  ==============================================================================
+
+    MakoADAA.h
+    R1.01 Antiderivative anti-aliasing (ADAA) for the tanh shapers.
+
+    A shaper makes harmonics above Nyquist that fold back as aliasing.
+    Oversampling fixes that by running the shaper faster. ADAA instead
+    replaces tanh(x[n]) with the average of tanh over the straight line
+    from x[n-1] to x[n], worked out from an antiderivative:
+
+      1st order:  y = (F1(x0) - F1(x1)) / (x0 - x1)                F1 = log(cosh(x))
+      2nd order:  y = 2 / (x0 - x2) * (D(x0, x1) - D(x1, x2))      D(a, b) = (F2(a) - F2(b)) / (a - b)
+                                                                   F2 = integral of F1 (a dilogarithm)
+
+    That averaging is a gentle low pass on what the shaper adds, which
+    takes out most of the aliasing at 1x. 1st order delays the shaped
+    signal by half a sample, 2nd order by one sample. That is not added
+    to the plugin latency, it only tilts the top octave of the blend.
+
+    When two inputs are nearly equal the divisions above are 0/0 and
+    rounding takes over, so inside MakoADAA_Eps the limit is used instead
+    (tanh or F1 of the midpoint). The math is done in double per lane,
+    in float 2nd order ADAA loses to rounding at normal playing levels.
+
+    F1 and F2 come from tables built at compile time (constexpr). Each knot
+    also has the exact slope and curvature (from the tanh table), so a
+    quintic Hermite between knots is smooth to the 2nd derivative. Past
+    MakoADAA_Max the log(1 + e^-2x) terms are below 2e-9 and the closed
+    forms are used. That is about the error overall.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include "MakoSIMD.h"
+#include "MakoTanh.h"
+
+const int MAKO_ADAA_OFF = 0;          //R1.01 Plain tanh (the Tanh_Tier version).
+const int MAKO_ADAA_1ST = 1;
+const int MAKO_ADAA_2ND = 2;
+
+const int MakoADAA_Knots = 161;
+constexpr double MakoADAA_Step = 16.0;        //R1.01 Knots per 1.0 of input.
+constexpr double MakoADAA_Max = 10.0;
+constexpr double MakoADAA_Ln2 = 0.69314718055994530942;
+constexpr double MakoADAA_Pi2_24 = 0.41123351671205660911;      //R1.01 pi^2 / 24.
+constexpr double MakoADAA_Eps1 = 1e-6;        //R1.01 Ill conditioned below this (x scaled), 1st order.
+constexpr double MakoADAA_Eps2 = 1e-4;        //R1.01 2nd order divides twice, so it needs more room.
+
+//==============================================================================
+//R1.01 Compile time math for the tables. No std:: math is constexpr in C++17.
+//==============================================================================
+
+//R1.01 log(1 + u) for 0 <= u <= 1, as 2 atanh(u / (2 + u)). The series term is at most 1/3.
+constexpr double mako_clog1p(double u)
+{
+    double t = u / (2.0 + u);
+    double t2 = t * t;
+    double term = t, sum = 0.0;
+    for (int k = 0; k < 20; k++)
+    {
+        sum += term / double(2 * k + 1);
+        term *= t2;
+    }
+    return 2.0 * sum;
+}
+
+//R1.01 Dilogarithm Li2(w) for 0 <= w <= .5 by its power series.
+constexpr double mako_cli2(double w)
+{
+    double term = w, sum = 0.0;
+    for (int k = 1; k < 56; k++)
+    {
+        sum += term / double(k * k);
+        term *= w;
+    }
+    return sum;
+}
+
+//R1.01 e^x for small |x| (only the knot spacing is needed), Taylor series.
+constexpr double mako_cexp_small(double x)
+{
+    double term = 1.0, sum = 1.0;
+    for (int k = 1; k < 20; k++)
+    {
+        term *= x / double(k);
+        sum += term;
+    }
+    return sum;
+}
+
+struct tp_adaa_table
+{
+    double F1[MakoADAA_Knots];        //R1.01 log(cosh(x)).
+    double T[MakoADAA_Knots];         //R1.01 tanh(x), the slope of F1.
+    double F2[MakoADAA_Knots];        //R1.01 Integral of F1 from 0. Its slope is F1.
+};
+
+//R1.01 With u = e^-2x (x >= 0):
+//R1.01   tanh(x)      = (1 - u) / (1 + u)
+//R1.01   log(cosh(x)) = x - ln2 + log(1 + u)
+//R1.01   F2(x)        = x^2/2 - x ln2 + pi^2/24 + Li2(-u)/2
+//R1.01 and Landen's identity Li2(-u) = -Li2(u / (1 + u)) - log(1 + u)^2 / 2 keeps the series argument <= .5.
+constexpr tp_adaa_table MakoADAA_Build()
+{
+    tp_adaa_table tb {};
+    const double q = mako_cexp_small(-2.0 / MakoADAA_Step);
+    double u = 1.0;
+    for (int t = 0; t < MakoADAA_Knots; t++)
+    {
+        double x = double(t) / MakoADAA_Step;
+        double l1p = mako_clog1p(u);
+        double li2 = -mako_cli2(u / (1.0 + u)) - .5 * l1p * l1p;
+        tb.T[t] = (1.0 - u) / (1.0 + u);
+        tb.F1[t] = x - MakoADAA_Ln2 + l1p;
+        tb.F2[t] = .5 * x * x - x * MakoADAA_Ln2 + MakoADAA_Pi2_24 + .5 * li2;
+        u *= q;
+    }
+    tb.F2[0] = 0.0;       //R1.01 Exact by definition, the series lands a rounding off.
+    return tb;
+}
+
+inline constexpr tp_adaa_table MakoADAA_Table = MakoADAA_Build();
+
+//==============================================================================
+//R1.01 Antiderivatives for any x.
+//==============================================================================
+
+//R1.01 Quintic Hermite thru two knots with their values, slopes and curvatures. h is the knot spacing.
+//R1.01 2nd order ADAA divides F2 differences twice, so F2 must be smooth to its 2nd derivative (a cubic
+//R1.01 is not, its curvature jumps at every knot and that shows up as clicks).
+inline double MakoADAA_Hermite(double p0, double p1, double m0, double m1, double c0, double c1, double t, double h)
+{
+    m0 *= h;
+    m1 *= h;
+    c0 *= h * h;
+    c1 *= h * h;
+    double dp = p1 - p0;
+    double a3 = 10.0 * dp - 6.0 * m0 - 4.0 * m1 - 1.5 * c0 + .5 * c1;
+    double a4 = -15.0 * dp + 8.0 * m0 + 7.0 * m1 + 1.5 * c0 - c1;
+    double a5 = 6.0 * dp - 3.0 * m0 - 3.0 * m1 - .5 * c0 + .5 * c1;
+    return ((((a5 * t + a4) * t + a3) * t + .5 * c0) * t + m0) * t + p0;
+}
+
+//R1.01 F1 = log(cosh(x)). Even.
+inline double MakoADAA_F1(double x)
+{
+    double ax = std::fabs(x);
+    if (MakoADAA_Max <= ax) return ax - MakoADAA_Ln2;
+    double pos = ax * MakoADAA_Step;
+    int idx = int(pos);
+    const tp_adaa_table& tb = MakoADAA_Table;
+    return MakoADAA_Hermite(tb.F1[idx], tb.F1[idx + 1], tb.T[idx], tb.T[idx + 1], 1.0 - tb.T[idx] * tb.T[idx], 1.0 - tb.T[idx + 1] * tb.T[idx + 1],
+                            pos - double(idx), 1.0 / MakoADAA_Step);
+}
+
+//R1.01 F2 = integral of F1 from 0. Odd.
+inline double MakoADAA_F2(double x)
+{
+    double ax = std::fabs(x);
+    double y;
+    if (MakoADAA_Max <= ax)
+        y = .5 * ax * ax - ax * MakoADAA_Ln2 + MakoADAA_Pi2_24;
+    else
+    {
+        double pos = ax * MakoADAA_Step;
+        int idx = int(pos);
+        const tp_adaa_table& tb = MakoADAA_Table;
+        y = MakoADAA_Hermite(tb.F2[idx], tb.F2[idx + 1], tb.F1[idx], tb.F1[idx + 1], tb.T[idx], tb.T[idx + 1], pos - double(idx), 1.0 / MakoADAA_Step);
+    }
+    return (x < 0.0) ? -y : y;
+}
+
+//==============================================================================
+//R1.01 The shapers. One state per channel per shaper, zeroed for silence.
+//==============================================================================
+struct tp_adaa_state {
+    double X1 = 0.0;      //R1.01 Last input.
+    double X2 = 0.0;      //R1.01 The one before (2nd order).
+    double F = 0.0;       //R1.01 F1(X1) or F2(X1), saved so each sample only looks up one value.
+    double D = 0.0;       //R1.01 D(X1, X2) (2nd order).
+};
+
+inline bool MakoADAA_Close(double a, double b, double eps)
+{
+    return std::fabs(a - b) < eps * (1.0 + std::fabs(a) + std::fabs(b));
+}
+
+inline double MakoADAA_1st(double x, tp_adaa_state& st)
+{
+    double F = MakoADAA_F1(x);
+    double y = MakoADAA_Close(x, st.X1, MakoADAA_Eps1) ? std::tanh(.5 * (x + st.X1)) : (F - st.F) / (x - st.X1);
+    st.X1 = x;
+    st.F = F;
+    return y;
+}
+
+inline double MakoADAA_2nd(double x, tp_adaa_state& st)
+{
+    double F = MakoADAA_F2(x);
+    double D = MakoADAA_Close(x, st.X1, MakoADAA_Eps2) ? MakoADAA_F1(.5 * (x + st.X1)) : (F - st.F) / (x - st.X1);
+
+    double y;
+    if (! MakoADAA_Close(x, st.X2, MakoADAA_Eps2))
+        y = 2.0 * (D - st.D) / (x - st.X2);
+    else
+    {
+        //R1.01 x and X2 are the same point, so expand around their midpoint instead.
+        double xb = .5 * (x + st.X2);
+        double delta = xb - st.X1;
+        if (MakoADAA_Close(xb, st.X1, MakoADAA_Eps2))
+            y = std::tanh(.5 * (xb + st.X1));
+        else
+            y = (2.0 / delta) * (MakoADAA_F1(xb) + (MakoADAA_F2(st.X1) - MakoADAA_F2(xb)) / delta);
+    }
+
+    st.X2 = st.X1;
+    st.X1 = x;
+    st.F = F;
+    st.D = D;
+    return y;
+}
+
+//R1.01 One lane group. st points at the MAKO_LANES states for the group. Only the first
+//R1.01 Active lanes have a channel, the rest are left at 0 (a mono or stereo group saves the work).
+//R1.01 Dup says every active lane has the same input (dual mono), so lane 0 is worked out and copied.
+//R1.01 Only st[0] moves then, the caller copies it to the other lanes after the block.
+template <int Order>
+inline mako_f4 MakoADAA(mako_f4 x, tp_adaa_state* st, int Active, bool Dup)
+{
+    float In[MAKO_LANES], Out[MAKO_LANES] = {};
+    mako_store(In, x);
+    const int Work = Dup ? 1 : Active;
+    for (int t = 0; t < Work; t++)
+        Out[t] = float((Order == MAKO_ADAA_2ND) ? MakoADAA_2nd(double(In[t]), st[t]) : MakoADAA_1st(double(In[t]), st[t]));
+    for (int t = Work; t < Active; t++)
+        Out[t] = Out[0];
+    return mako_load(Out);
+}
+
+//R1.01 The shaper the block engine calls. Order is fixed at compile time, so plain tanh costs nothing extra.
+template <int TanhTier, int Order>
+inline mako_f4 MakoShape(mako_f4 x, tp_adaa_state* st, int Active, bool Dup)
+{
+    if constexpr (Order == MAKO_ADAA_OFF)
+    {
+        (void) st;
+        (void) Active;
+        (void) Dup;
+        return MakoTanh<TanhTier>(x);
+    }
+    else
+        return MakoADAA<Order>(x, st, Active, Dup);
+}
@@ -0,0 +1,312 @@
+/*
+  ==============================================================================
+
+    MakoAnalyzer.h
+    R1.01 Spectrum analyzer and filter response for the editor.
+
+    The audio thread only copies samples into two rings (MakoSampleTap),
+    one before and one after the OD, and only while the analyzer is open.
+    It never waits. If the analyzer falls behind, new samples are dropped.
+
+    MakoAnalyzer is a background thread owned by the editor. About 30 times
+    a second it takes what is in the rings, runs a Hann windowed FFT on each
+    new half frame (at most MAKO_ANALYZER_MAXFRAMES per ring, older samples
+    are skipped) and turns the power into MAKO_ANALYZER_POINTS log spaced
+    points from 20 Hz to 20 kHz.
+
+    It also draws the voicing. The processor publishes the Low, High and
+    Enh filter coeffs it is using, and the response is only worked out
+    again when they change. The Enh stages add tanh(Enh x Filter) to the
+    signal, so for small signals they are 1 + Enh x H(f). The curve is
+    Low x (1 + EnhHigh x H) x High x (1 + EnhLow x H), without drive.
+
+    The results go to the editor thru another MakoTripleBuffer, so the
+    editor just copies the latest view on its timer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <vector>
+
+const int MAKO_ANALYZER_ORDER = 11;
+const int MAKO_ANALYZER_FFT = 1 << MAKO_ANALYZER_ORDER;      //R1.01 2048 samples, 23 Hz bins at 48k.
+const int MAKO_ANALYZER_HOP = MAKO_ANALYZER_FFT / 2;         //R1.01 50% overlap.
+const int MAKO_ANALYZER_POINTS = 160;                       //R1.01 Points across the display.
+const int MAKO_ANALYZER_HZ = 30;                            //R1.01 Updates per second.
+const int MAKO_ANALYZER_MAXFRAMES = 4;                      //R1.01 FFTs per ring per update. Caps the CPU at high rates.
+constexpr float MAKO_ANALYZER_LOHZ = 20.0f;
+constexpr float MAKO_ANALYZER_HIHZ = 20000.0f;
+constexpr float MAKO_ANALYZER_FLOOR = -120.0f;              //R1.01 dB for an empty bin.
+
+//==============================================================================
+//R1.01 Latest value from one thread to another, wait free on both sides. The writer fills its own
+//R1.01 copy and swaps it into the middle, the reader swaps the middle out when it has been written.
+//R1.01 Nobody ever touches a copy the other side has, so there are no locks and no torn reads.
+template <typename T>
+class MakoTripleBuffer
+{
+public:
+    //R1.01 Writer thread only.
+    T& Back() { return Slot[Write]; }
+    void Publish()
+    {
+        Write = Middle.exchange(Write | e_Fresh, std::memory_order_acq_rel) & e_Index;
+    }
+
+    //R1.01 Reader thread only. True and a new value in Front() if one was published since the last call.
+    bool Fetch()
+    {
+        if ((Middle.load(std::memory_order_relaxed) & e_Fresh) == 0) return false;
+        Read = Middle.exchange(Read, std::memory_order_acq_rel) & e_Index;
+        return true;
+    }
+    const T& Front() const { return Slot[Read]; }
+
+private:
+    static const int e_Index = 3;
+    static const int e_Fresh = 4;
+    T Slot[3] = {};
+    int Write = 0;
+    int Read = 1;
+    std::atomic<int> Middle { 2 };
+};
+
+//==============================================================================
+//R1.01 Samples from the audio thread. One producer (audio) and one consumer (analyzer thread).
+class MakoSampleTap
+{
+public:
+    //R1.01 About .35 s at 48k. The analyzer takes them every 33 ms.
+    static const int Size = 16384;
+
+    //R1.01 Audio thread. Copies what fits and drops the rest.
+    void Push(const float* data, int count)
+    {
+        int start1, size1, start2, size2;
+        Fifo.prepareToWrite(count, start1, size1, start2, size2);
+        if (0 < size1) std::memcpy(Data + start1, data, sizeof(float) * size_t(size1));
+        if (0 < size2) std::memcpy(Data + start2, data + size1, sizeof(float) * size_t(size2));
+        Fifo.finishedWrite(size1 + size2);
+    }
+
+    //R1.01 Analyzer thread.
+    int Ready() const { return Fifo.getNumReady(); }
+    void Pop(float* dest, int count)
+    {
+        int start1, size1, start2, size2;
+        Fifo.prepareToRead(count, start1, size1, start2, size2);
+        if (dest != nullptr)
+        {
+            if (0 < size1) std::memcpy(dest, Data + start1, sizeof(float) * size_t(size1));
+            if (0 < size2) std::memcpy(dest + size1, Data + start2, sizeof(float) * size_t(size2));
+        }
+        Fifo.finishedRead(size1 + size2);
+    }
+    void Skip(int count) { Pop(nullptr, count); }
+
+private:
+    juce::AbstractFifo Fifo { Size };
+    float Data[Size] = {};
+};
+
+//==============================================================================
+//R1.01 Voicing filter coeffs, a0 a1 a2 b1 b2 each, as the audio thread last used them.
+struct tp_analyzer_coeffs {
+    float Rate = 0.0f;          //R1.01 Rate the filters run at (SampleRate).
+    float EnhHigh = 0.0f;       //R1.01 Enh amounts, 0-1.
+    float EnhLow = 0.0f;
+    float Low[5] = {};
+    float High[5] = {};
+    float EnhHighF[5] = {};
+    float EnhLowF[5] = {};
+};
+
+//R1.01 What the editor draws. All in dB at MakoAnalyzer::PointHz(p).
+struct tp_analyzer_view {
+    float Pre[MAKO_ANALYZER_POINTS] = {};       //R1.01 Input spectrum, dBFS.
+    float Post[MAKO_ANALYZER_POINTS] = {};      //R1.01 Output spectrum, dBFS.
+    float Response[MAKO_ANALYZER_POINTS] = {};  //R1.01 Voicing gain, dB.
+    bool HasResponse = false;
+};
+
+//==============================================================================
+class MakoAnalyzer : public juce::Thread
+{
+public:
+    MakoAnalyzer(MakoSampleTap& pre, MakoSampleTap& post, MakoTripleBuffer<tp_analyzer_coeffs>& coeffs)
+        : juce::Thread("MakoOD Analyzer"), Coeffs(coeffs)
+    {
+        Tap[0] = &pre;
+        Tap[1] = &post;
+        for (int t = 0; t < 2; t++)
+        {
+            History[t].assign(size_t(MAKO_ANALYZER_FFT), 0.0f);
+            for (float& dB : Spectrum[t]) dB = MAKO_ANALYZER_FLOOR;
+        }
+
+        //R1.01 Hann window, scaled so a full scale sine reads 0 dBFS. Twiddles and bit reverse for the FFT.
+        Window.resize(size_t(MAKO_ANALYZER_FFT));
+        for (int t = 0; t < MAKO_ANALYZER_FFT; t++)
+            Window[size_t(t)] = float((.5 - .5 * std::cos(2.0 * juce::MathConstants<double>::pi * t / MAKO_ANALYZER_FFT)) * 4.0 / MAKO_ANALYZER_FFT);
+        Twiddle.resize(size_t(MAKO_ANALYZER_FFT / 2));
+        for (int t = 0; t < MAKO_ANALYZER_FFT / 2; t++)
+            Twiddle[size_t(t)] = std::polar(1.0f, float(-2.0 * juce::MathConstants<double>::pi * t / MAKO_ANALYZER_FFT));
+        Reverse.resize(size_t(MAKO_ANALYZER_FFT));
+        for (int t = 0; t < MAKO_ANALYZER_FFT; t++)
+        {
+            int r = 0;
+            for (int b = 0; b < MAKO_ANALYZER_ORDER; b++) r |= ((t >> b) & 1) << (MAKO_ANALYZER_ORDER - 1 - b);
+            Reverse[size_t(t)] = r;
+        }
+        Frame.resize(size_t(MAKO_ANALYZER_FFT));
+        Power.resize(size_t(MAKO_ANALYZER_FFT / 2 + 1));
+    }
+
+    ~MakoAnalyzer() override { stopThread(1000); }
+
+    //R1.01 Host rate of the taps. Any thread.
+    void SetRate(double rate) { TapRate.store(rate); }
+
+    //R1.01 Display point p (0 to MAKO_ANALYZER_POINTS - 1) in Hz, log spaced.
+    static float PointHz(int p)
+    {
+        return MAKO_ANALYZER_LOHZ * std::pow(MAKO_ANALYZER_HIHZ / MAKO_ANALYZER_LOHZ, float(p) / float(MAKO_ANALYZER_POINTS - 1));
+    }
+
+    //R1.01 Results for the editor.
+    MakoTripleBuffer<tp_analyzer_view> View;
+
+    void run() override
+    {
+        while (!threadShouldExit())
+        {
+            Analyzer_Update();
+            wait(1000 / MAKO_ANALYZER_HZ);
+        }
+    }
+
+private:
+    MakoSampleTap* Tap[2] = {};
+    MakoTripleBuffer<tp_analyzer_coeffs>& Coeffs;
+    std::atomic<double> TapRate { 48000.0 };
+
+    std::vector<float> History[2];              //R1.01 Last MAKO_ANALYZER_FFT samples of each tap.
+    float Spectrum[2][MAKO_ANALYZER_POINTS];    //R1.01 Smoothed dB per display point.
+    float Response[MAKO_ANALYZER_POINTS] = {};
+    bool HasResponse = false;
+
+    std::vector<float> Window;
+    std::vector<std::complex<float>> Twiddle;
+    std::vector<int> Reverse;
+    std::vector<std::complex<float>> Frame;
+    std::vector<float> Power;
+
+    void Analyzer_Update()
+    {
+        bool Changed = false;
+        for (int t = 0; t < 2; t++)
+        {
+            //R1.01 Only the newest frames are worth the CPU. Anything older than that is thrown away.
+            int Ready = Tap[t]->Ready();
+            int Keep = MAKO_ANALYZER_MAXFRAMES * MAKO_ANALYZER_HOP;
+            if (Keep < Ready)
+            {
+                Tap[t]->Skip(Ready - Keep);
+                Ready = Keep;
+            }
+
+            float* Hist = History[t].data();
+            while (MAKO_ANALYZER_HOP <= Ready)
+            {
+                std::memmove(Hist, Hist + MAKO_ANALYZER_HOP, sizeof(float) * size_t(MAKO_ANALYZER_FFT - MAKO_ANALYZER_HOP));
+                Tap[t]->Pop(Hist + MAKO_ANALYZER_FFT - MAKO_ANALYZER_HOP, MAKO_ANALYZER_HOP);
+                Ready -= MAKO_ANALYZER_HOP;
+                Analyzer_Frame(Hist, Spectrum[t]);
+                Changed = true;
+            }
+        }
+
+        //R1.01 The voicing only changes when a knob moves.
+        if (Coeffs.Fetch())
+        {
+            Analyzer_Response(Coeffs.Front());
+            Changed = true;
+        }
+
+        if (!Changed) return;
+        tp_analyzer_view& v = View.Back();
+        std::memcpy(v.Pre, Spectrum[0], sizeof(v.Pre));
+        std::memcpy(v.Post, Spectrum[1], sizeof(v.Post));
+        std::memcpy(v.Response, Response, sizeof(v.Response));
+        v.HasResponse = HasResponse;
+        View.Publish();
+    }
+
+    //R1.01 One FFT of the last MAKO_ANALYZER_FFT samples, folded into the display points.
+    void Analyzer_Frame(const float* Hist, float* Spec)
+    {
+        for (int t = 0; t < MAKO_ANALYZER_FFT; t++)
+            Frame[size_t(Reverse[size_t(t)])] = std::complex<float>(Hist[t] * Window[size_t(t)], 0.0f);
+
+        //R1.01 In place radix 2.
+        for (int Len = 2; Len <= MAKO_ANALYZER_FFT; Len <<= 1)
+        {
+            const int Half = Len / 2;
+            const int Step = MAKO_ANALYZER_FFT / Len;
+            for (int s = 0; s < MAKO_ANALYZER_FFT; s += Len)
+                for (int k = 0; k < Half; k++)
+                {
+                    std::complex<float> odd = Frame[size_t(s + k + Half)] * Twiddle[size_t(k * Step)];
+                    Frame[size_t(s + k + Half)] = Frame[size_t(s + k)] - odd;
+                    Frame[size_t(s + k)] += odd;
+                }
+        }
+        for (int b = 0; b <= MAKO_ANALYZER_FFT / 2; b++) Power[size_t(b)] = std::norm(Frame[size_t(b)]);
+
+        //R1.01 Each point takes the loudest bin between it and the next point, or the nearest bin
+        //R1.01 where the points are closer than the bins. Falls about 20 dB a second, rises at once.
+        const float Rate = float(TapRate.load());
+        const float BinHz = Rate / float(MAKO_ANALYZER_FFT);
+        const float Fall = 20.0f * float(MAKO_ANALYZER_HOP) / Rate;
+        for (int p = 0; p < MAKO_ANALYZER_POINTS; p++)
+        {
+            int Lo = juce::jlimit(1, MAKO_ANALYZER_FFT / 2, juce::roundToInt(PointHz(p) / BinHz));
+            int Hi = juce::jlimit(Lo, MAKO_ANALYZER_FFT / 2, juce::roundToInt(PointHz(juce::jmin(p + 1, MAKO_ANALYZER_POINTS - 1)) / BinHz) - 1);
+            float Peak = 0.0f;
+            for (int b = Lo; b <= Hi; b++) Peak = juce::jmax(Peak, Power[size_t(b)]);
+            float dB = (0.0f < Peak) ? juce::jmax(MAKO_ANALYZER_FLOOR, 10.0f * std::log10(Peak)) : MAKO_ANALYZER_FLOOR;
+            Spec[p] = juce::jmax(dB, Spec[p] - Fall);
+        }
+    }
+
+    //R1.01 |H| of one biquad at w radians per sample. y = a0 x + a1 x1 + a2 x2 - b1 y1 - b2 y2.
+    static std::complex<double> Analyzer_BiQuad(const float* c, double w)
+    {
+        const std::complex<double> z1 = std::polar(1.0, -w);
+        const std::complex<double> z2 = z1 * z1;
+        return (double(c[0]) + double(c[1]) * z1 + double(c[2]) * z2) / (1.0 + double(c[3]) * z1 + double(c[4]) * z2);
+    }
+
+    void Analyzer_Response(const tp_analyzer_coeffs& c)
+    {
+        HasResponse = (0.0f < c.Rate);
+        if (!HasResponse) return;
+
+        for (int p = 0; p < MAKO_ANALYZER_POINTS; p++)
+        {
+            //R1.01 Past Nyquist the filters do not exist, hold the last value.
+            double w = 2.0 * juce::MathConstants<double>::pi * juce::jmin(double(PointHz(p)), .499 * double(c.Rate)) / double(c.Rate);
+            std::complex<double> H = Analyzer_BiQuad(c.Low, w) * Analyzer_BiQuad(c.High, w);
+            H *= 1.0 + double(c.EnhHigh) * Analyzer_BiQuad(c.EnhHighF, w);
+            H *= 1.0 + double(c.EnhLow) * Analyzer_BiQuad(c.EnhLowF, w);
+            Response[p] = float(20.0 * std::log10(juce::jmax(1e-6, std::abs(H))));
+        }
+    }
+};
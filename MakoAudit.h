@@ -0,0 +1,508 @@
+/*
+  ==============================================================================
+
+    MakoAudit.h
+    R1.01 Optional real time safety audit for the audio thread.
+
+    Build with MAKO_RTAUDIT=1 to turn it on. Otherwise the macros below are
+    empty and the processor has no audit code at all.
+
+    processBlock and prepareToPlay each open an audit scope. While a thread
+    is inside one, every heap allocation or free, lock and blocking system
+    call it makes is logged with a stack. Inside processBlock each one is a
+    violation. prepareToPlay is where we are supposed to allocate, so its
+    events are only notes, to show what it does.
+
+    The hooks are only compiled into the one file that defines
+    MAKO_AUDIT_HOOKS before including this (the audit and verify tools do).
+      Linux (glibc): malloc, calloc, realloc, free, the aligned allocs,
+        pthread mutex/rwlock/cond waits, sem_wait, sleeps, sched_yield,
+        open/read/write/close. operator new ends up in malloc, so it is
+        caught too. Symbol interposition only works reliably in an
+        executable, so use the tools, not a plugin in a host.
+      Everything else: operator new and delete only.
+    Stacks come from backtrace() (Linux, macOS) or CaptureStackBackTrace
+    (Windows, addresses only).
+
+    The log is two fixed arrays, so logging never allocates. It keeps the
+    first MAKO_AUDIT_EVENTS different violations and notes. The same call
+    from the same place again only adds to its hit count.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef MAKO_RTAUDIT
+ #define MAKO_RTAUDIT 0
+#endif
+
+#if MAKO_RTAUDIT
+ #if defined(__GLIBC__) || defined(__APPLE__)
+  #include <execinfo.h>
+  #define MAKO_AUDIT_STACKS 1
+ #elif defined(_WIN32)
+  #include <windows.h>
+  #define MAKO_AUDIT_STACKS 1
+ #else
+  #define MAKO_AUDIT_STACKS 0
+ #endif
+#endif
+
+const int MAKO_AUDIT_ALLOC = 0;     //R1.01 Heap allocation.
+const int MAKO_AUDIT_FREE = 1;      //R1.01 Heap free. Can take a lock in the allocator, and often follows an allocation.
+const int MAKO_AUDIT_LOCK = 2;      //R1.01 Mutex, rwlock, condition or semaphore wait.
+const int MAKO_AUDIT_SYSCALL = 3;   //R1.01 File IO, sleeps and yields.
+const int MAKO_AUDIT_KINDS = 4;
+const int MAKO_AUDIT_EVENTS = 64;   //R1.01 Events kept with their stack.
+const int MAKO_AUDIT_FRAMES = 24;
+
+#if MAKO_RTAUDIT
+
+//R1.01 GCC and Clang: initial-exec TLS never allocates on first use, even in a dlopen'd module.
+//R1.01 Otherwise the malloc hook could end up calling itself.
+#if defined(__GNUC__)
+ #define MAKO_AUDIT_TLS __attribute__((tls_model("initial-exec")))
+#else
+ #define MAKO_AUDIT_TLS
+#endif
+
+struct tp_audit_event {
+    int Kind;
+    const char* Scope;
+    const char* What;
+    size_t Size;
+    int Hits;               //R1.01 Times the same call was made from the same place.
+    int Frames;
+    void* Stack[MAKO_AUDIT_FRAMES];
+};
+
+//R1.01 Per thread. Depth counts nested scopes. Busy stops the hooks from logging our own work.
+struct tp_audit_thread {
+    int Depth;
+    bool Strict;
+    bool Busy;
+    const char* Scope;
+};
+
+inline thread_local tp_audit_thread Audit_Thread MAKO_AUDIT_TLS = { 0, false, false, nullptr };
+
+class MakoAudit
+{
+public:
+    static MakoAudit& Get()
+    {
+        static MakoAudit audit;
+        return audit;
+    }
+
+    //R1.01 Clear the log. Not while a scope is open on another thread.
+    void Reset()
+    {
+        for (int s = 0; s < 2; s++)
+        {
+            Count[s].store(0);
+            Lost[s].store(0);
+            for (int k = 0; k < MAKO_AUDIT_KINDS; k++) Totals[s][k].store(0);
+        }
+    }
+
+    //R1.01 Called by the hooks. Cheap when the thread is not in a scope.
+    static void Event(int Kind, const char* What, size_t Size)
+    {
+        tp_audit_thread& th = Audit_Thread;
+        if ((th.Depth == 0) || th.Busy) return;
+        th.Busy = true;
+        Get().Log(th, Kind, What, Size);
+        th.Busy = false;
+    }
+
+    int Violations() const
+    {
+        int n = 0;
+        for (int k = 0; k < MAKO_AUDIT_KINDS; k++) n += Totals[1][k].load();
+        return n;
+    }
+    int Notes() const
+    {
+        int n = 0;
+        for (int k = 0; k < MAKO_AUDIT_KINDS; k++) n += Totals[0][k].load();
+        return n;
+    }
+
+    static const char* KindName(int Kind)
+    {
+        static const char* Names[MAKO_AUDIT_KINDS] = { "alloc", "free", "lock", "syscall" };
+        return Names[Kind];
+    }
+
+    //R1.01 Counts, then every kept event with its stack, violations first. Strict leaves out the notes.
+    //R1.01 Allocates (symbol names), so only call it outside a scope.
+    void Report(std::FILE* out, bool StrictOnly) const
+    {
+        std::fprintf(out, "audit: %d violations (", Violations());
+        for (int k = 0; k < MAKO_AUDIT_KINDS; k++) std::fprintf(out, "%s%s %d", (k == 0) ? "" : ", ", KindName(k), Totals[1][k].load());
+        std::fprintf(out, "), %d notes outside the audio thread\n", Notes());
+
+        for (int s = 1; (StrictOnly ? 1 : 0) <= s; s--)
+        {
+            const int Kept = juce::jmin(Count[s].load(), MAKO_AUDIT_EVENTS);
+            for (int e = 0; e < Kept; e++)
+            {
+                const tp_audit_event& ev = Events[s][e];
+                std::fprintf(out, "%s: %s %s", (s == 1) ? "VIOLATION" : "note", ev.Scope, KindName(ev.Kind));
+                if (ev.What != nullptr) std::fprintf(out, " %s", ev.What);
+                if (ev.Kind == MAKO_AUDIT_ALLOC) std::fprintf(out, " %zu bytes", ev.Size);
+                std::fprintf(out, ", %d times\n", ev.Hits);
+                PrintStack(out, ev);
+            }
+            if (Lost[s].load() != 0)
+                std::fprintf(out, "audit: %d more %s not kept\n", Lost[s].load(), (s == 1) ? "violations" : "notes");
+        }
+    }
+
+    //R1.01 Load whatever the stack capture needs (libgcc) now, so the first event does not.
+    void Warm()
+    {
+#if MAKO_AUDIT_STACKS && !defined(_WIN32)
+        void* frames[4];
+        backtrace(frames, 4);
+#endif
+    }
+
+private:
+    MakoAudit() { Reset(); }
+
+    //R1.01 [0] notes, [1] violations.
+    std::atomic<int> Count[2];
+    std::atomic<int> Lost[2];
+    std::atomic<int> Totals[2][MAKO_AUDIT_KINDS];
+    tp_audit_event Events[2][MAKO_AUDIT_EVENTS];
+
+    void Log(const tp_audit_thread& th, int Kind, const char* What, size_t Size)
+    {
+        const int s = th.Strict ? 1 : 0;
+        Totals[s][Kind].fetch_add(1);
+
+        void* Stack[MAKO_AUDIT_FRAMES];
+#if MAKO_AUDIT_STACKS && defined(_WIN32)
+        int Frames = int(CaptureStackBackTrace(2, MAKO_AUDIT_FRAMES, Stack, nullptr));
+#elif MAKO_AUDIT_STACKS
+        int Frames = backtrace(Stack, MAKO_AUDIT_FRAMES);
+#else
+        int Frames = 0;
+#endif
+
+        //R1.01 Seen before? Events are only ever added, so the ones below Count are complete
+        //R1.01 (a single audio thread is the normal case anyway).
+        const int Kept = juce::jmin(Count[s].load(), MAKO_AUDIT_EVENTS);
+        for (int e = 0; e < Kept; e++)
+        {
+            tp_audit_event& old = Events[s][e];
+            if ((old.Kind == Kind) && (old.What == What) && (old.Frames == Frames)
+                && (std::memcmp(old.Stack, Stack, sizeof(void*) * size_t(Frames)) == 0))
+            {
+                old.Hits++;
+                return;
+            }
+        }
+
+        int slot = Count[s].load();
+        if (MAKO_AUDIT_EVENTS <= slot)
+        {
+            Lost[s].fetch_add(1);
+            return;
+        }
+        tp_audit_event& ev = Events[s][slot];
+        ev.Kind = Kind;
+        ev.Scope = th.Scope;
+        ev.What = What;
+        ev.Size = Size;
+        ev.Hits = 1;
+        ev.Frames = Frames;
+        std::memcpy(ev.Stack, Stack, sizeof(void*) * size_t(Frames));
+        Count[s].store(slot + 1);
+    }
+
+    static void PrintStack(std::FILE* out, const tp_audit_event& ev)
+    {
+#if MAKO_AUDIT_STACKS && !defined(_WIN32)
+        char** names = backtrace_symbols(ev.Stack, ev.Frames);
+        for (int f = 0; f < ev.Frames; f++) std::fprintf(out, "    %s\n", (names != nullptr) ? names[f] : "?");
+        std::free(names);
+#else
+        for (int f = 0; f < ev.Frames; f++) std::fprintf(out, "    %p\n", ev.Stack[f]);
+        if (ev.Frames == 0) std::fprintf(out, "    (no stack on this platform)\n");
+#endif
+    }
+};
+
+//R1.01 Marks the code the calling thread runs until the end of the block. Strict for the audio thread.
+class MakoAuditScope
+{
+public:
+    MakoAuditScope(const char* Scope, bool Strict)
+    {
+        tp_audit_thread& th = Audit_Thread;
+        Saved = th;
+        th.Depth++;
+        th.Strict = Strict || Saved.Strict;
+        th.Scope = Strict ? Scope : ((Saved.Scope != nullptr) ? Saved.Scope : Scope);
+    }
+    ~MakoAuditScope()
+    {
+        tp_audit_thread& th = Audit_Thread;
+        th.Depth = Saved.Depth;
+        th.Strict = Saved.Strict;
+        th.Scope = Saved.Scope;
+    }
+
+private:
+    tp_audit_thread Saved;
+};
+
+//R1.01 Lets a scope call something we know is not real time safe (a tool filling in test input).
+class MakoAuditPause
+{
+public:
+    MakoAuditPause() : WasBusy(Audit_Thread.Busy) { Audit_Thread.Busy = true; }
+    ~MakoAuditPause() { Audit_Thread.Busy = WasBusy; }
+
+private:
+    bool WasBusy;
+};
+
+ #define MAKO_AUDIT_SCOPE(name)         MakoAuditScope makoAuditScope(name, true)
+ #define MAKO_AUDIT_PREPARE(name)       MakoAuditScope makoAuditScope(name, false)
+
+//==============================================================================
+//R1.01 The hooks. Exactly one file of a program defines MAKO_AUDIT_HOOKS before including this.
+#if defined(MAKO_AUDIT_HOOKS)
+
+#if defined(__GLIBC__)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <time.h>
+#include <unistd.h>
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void __libc_free(void*);
+}
+
+//R1.01 The real function, found once. dlsym itself may allocate, so the hooks do not log while it runs.
+#define MAKO_AUDIT_NEXT(ret, name, args)                                                    \
+    static ret (*real) args = nullptr;                                                      \
+    if (real == nullptr)                                                                    \
+    {                                                                                       \
+        MakoAuditPause pause;                                                               \
+        real = reinterpret_cast<ret (*) args>(dlsym(RTLD_NEXT, name));                      \
+    }
+
+extern "C" {
+
+void* malloc(size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "malloc", size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "calloc", count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "realloc", size);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    if (ptr != nullptr) MakoAudit::Event(MAKO_AUDIT_FREE, "free", 0);
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** ptr, size_t align, size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "posix_memalign", size);
+    *ptr = __libc_memalign(align, size);
+    return (*ptr == nullptr) ? ENOMEM : 0;
+}
+
+void* aligned_alloc(size_t align, size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "aligned_alloc", size);
+    return __libc_memalign(align, size);
+}
+
+void* memalign(size_t align, size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "memalign", size);
+    return __libc_memalign(align, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* m)
+{
+    MAKO_AUDIT_NEXT(int, "pthread_mutex_lock", (pthread_mutex_t*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "pthread_mutex_lock", 0);
+    return real(m);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* l)
+{
+    MAKO_AUDIT_NEXT(int, "pthread_rwlock_rdlock", (pthread_rwlock_t*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "pthread_rwlock_rdlock", 0);
+    return real(l);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* l)
+{
+    MAKO_AUDIT_NEXT(int, "pthread_rwlock_wrlock", (pthread_rwlock_t*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "pthread_rwlock_wrlock", 0);
+    return real(l);
+}
+
+int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m)
+{
+    MAKO_AUDIT_NEXT(int, "pthread_cond_wait", (pthread_cond_t*, pthread_mutex_t*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "pthread_cond_wait", 0);
+    return real(c, m);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t)
+{
+    MAKO_AUDIT_NEXT(int, "pthread_cond_timedwait", (pthread_cond_t*, pthread_mutex_t*, const struct timespec*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "pthread_cond_timedwait", 0);
+    return real(c, m, t);
+}
+
+int sem_wait(sem_t* s)
+{
+    MAKO_AUDIT_NEXT(int, "sem_wait", (sem_t*));
+    MakoAudit::Event(MAKO_AUDIT_LOCK, "sem_wait", 0);
+    return real(s);
+}
+
+int nanosleep(const struct timespec* req, struct timespec* rem)
+{
+    MAKO_AUDIT_NEXT(int, "nanosleep", (const struct timespec*, struct timespec*));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "nanosleep", 0);
+    return real(req, rem);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const struct timespec* req, struct timespec* rem)
+{
+    MAKO_AUDIT_NEXT(int, "clock_nanosleep", (clockid_t, int, const struct timespec*, struct timespec*));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "clock_nanosleep", 0);
+    return real(clock, flags, req, rem);
+}
+
+int usleep(useconds_t us)
+{
+    MAKO_AUDIT_NEXT(int, "usleep", (useconds_t));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "usleep", 0);
+    return real(us);
+}
+
+int sched_yield()
+{
+    MAKO_AUDIT_NEXT(int, "sched_yield", ());
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "sched_yield", 0);
+    return real();
+}
+
+int open(const char* path, int flags, ...)
+{
+    MAKO_AUDIT_NEXT(int, "open", (const char*, int, ...));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "open", 0);
+    mode_t mode = 0;
+    if ((flags & O_CREAT) != 0)
+    {
+        va_list args;
+        va_start(args, flags);
+        mode = mode_t(va_arg(args, int));
+        va_end(args);
+    }
+    return real(path, flags, mode);
+}
+
+ssize_t read(int fd, void* buf, size_t count)
+{
+    MAKO_AUDIT_NEXT(ssize_t, "read", (int, void*, size_t));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "read", 0);
+    return real(fd, buf, count);
+}
+
+ssize_t write(int fd, const void* buf, size_t count)
+{
+    MAKO_AUDIT_NEXT(ssize_t, "write", (int, const void*, size_t));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "write", 0);
+    return real(fd, buf, count);
+}
+
+int close(int fd)
+{
+    MAKO_AUDIT_NEXT(int, "close", (int));
+    MakoAudit::Event(MAKO_AUDIT_SYSCALL, "close", 0);
+    return real(fd);
+}
+
+}   // extern "C"
+
+#undef MAKO_AUDIT_NEXT
+
+#else
+
+//R1.01 No C library hooks here. Catch the C++ allocations at least.
+#include <new>
+#include <cstdlib>
+
+void* operator new(std::size_t size)
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "operator new", size);
+    if (void* p = std::malloc((size == 0) ? 1 : size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    MakoAudit::Event(MAKO_AUDIT_ALLOC, "operator new", size);
+    return std::malloc((size == 0) ? 1 : size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t& nt) noexcept { return operator new(size, nt); }
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr) MakoAudit::Event(MAKO_AUDIT_FREE, "operator delete", 0);
+    std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { operator delete(ptr); }
+
+#endif
+
+#endif  // MAKO_AUDIT_HOOKS
+
+#else
+
+ #define MAKO_AUDIT_SCOPE(name)
+ #define MAKO_AUDIT_PREPARE(name)
+
+#endif  // MAKO_RTAUDIT
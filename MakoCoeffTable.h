@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    MakoCoeffTable.h
+    R1.01 Precalculated biquad coeffs for a range of filter frequencies.
+
+    One entry per Hz. Looking up a frequency between two entries blends
+    them, so a sweep never needs pow/tan on the audio thread. Tables are
+    shared by every plugin instance running at the same sample rate and
+    freed when the last one lets go.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+//R1.01 The five coeffs our biquads use.
+struct tp_coeff5 {
+    float a0;
+    float a1;
+    float a2;
+    float b1;
+    float b2;
+};
+
+struct tp_coeff_table {
+    float Fs = 0.0f;
+    int Fmin = 0;
+    int Fmax = 0;
+    std::vector<tp_coeff5> Coeffs;    //R1.01 Coeffs[t] is the filter at Fmin + t Hz.
+
+    //R1.01 Blend the two entries around Fc. Returns false if Fc is outside the table.
+    bool Lookup(float Fc, tp_coeff5& out) const
+    {
+        float pos = Fc - float(Fmin);
+        if ((pos < 0.0f) || (float(Fmax - Fmin) < pos)) return false;
+        int idx = int(pos);
+        if (Fmax - Fmin <= idx) idx = Fmax - Fmin - 1;
+        float frac = pos - float(idx);
+        const tp_coeff5& c0 = Coeffs[idx];
+        const tp_coeff5& c1 = Coeffs[idx + 1];
+        out.a0 = c0.a0 + frac * (c1.a0 - c0.a0);
+        out.a1 = c0.a1 + frac * (c1.a1 - c0.a1);
+        out.a2 = c0.a2 + frac * (c1.a2 - c0.a2);
+        out.b1 = c0.b1 + frac * (c1.b1 - c0.b1);
+        out.b2 = c0.b2 + frac * (c1.b2 - c0.b2);
+        return true;
+    }
+};
+
+//R1.01 Find (or build) the table for one rate, range and filter design.
+//R1.01 Locks a mutex and may allocate, so call from prepareToPlay, never from processBlock.
+//R1.01 Design names the filter type (e.g. "bp18q707") so different filters never share a table.
+inline std::shared_ptr<const tp_coeff_table> MakoCoeffTable_Get(const char* Design, float Fs, int Fmin, int Fmax, std::function<tp_coeff5(float Fc, float Fs)> Calc)
+{
+    typedef std::tuple<std::string, float, int, int> tp_key;
+    static std::mutex lock;
+    static std::map<tp_key, std::weak_ptr<const tp_coeff_table>> cache;
+
+    std::lock_guard<std::mutex> guard(lock);
+    tp_key key(Design, Fs, Fmin, Fmax);
+    if (std::shared_ptr<const tp_coeff_table> found = cache[key].lock())
+        return found;
+
+    auto table = std::make_shared<tp_coeff_table>();
+    table->Fs = Fs;
+    table->Fmin = Fmin;
+    table->Fmax = Fmax;
+    table->Coeffs.resize(size_t(Fmax - Fmin + 1));
+    for (int t = 0; t <= Fmax - Fmin; t++)
+        table->Coeffs[t] = Calc(float(Fmin + t), Fs);
+
+    //R1.01 Drop tables nobody holds any more (an old sample rate), so the map does not grow forever.
+    for (auto it = cache.begin(); it != cache.end(); )
+    {
+        if (it->second.expired()) it = cache.erase(it);
+        else ++it;
+    }
+    cache[key] = table;
+    return table;
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    MakoMeter.h
+    R1.01 Meter data from the audio thread to the editor.
+
+    The processor pushes one small frame per block and the editor pops
+    them on its timer. It is a single producer, single consumer queue
+    (juce::AbstractFifo), so neither side ever locks or waits. If the
+    editor falls behind, new frames are dropped, not queued.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//R1.01 What one processed block looked like.
+struct tp_meter_frame {
+    float InPeak = 0.0f;        //R1.01 Largest input sample, any channel.
+    float InRms = 0.0f;         //R1.01 RMS of all input channels.
+    float OutPeak = 0.0f;
+    float OutRms = 0.0f;
+    float GateGain = 1.0f;      //R1.01 Noise gate gain at the end of the block, most closed channel. 1 = open.
+    int Clips = 0;              //R1.01 Output samples that hit the clipper.
+    int Samples = 0;            //R1.01 Block length, so the editor can weight the RMS.
+};
+
+class MakoMeterFifo
+{
+public:
+    //R1.01 About .25 s of 32 sample blocks at 48k, plenty for a 60 Hz editor.
+    static const int Size = 512;
+
+    //R1.01 Audio thread. Returns false (frame dropped) if the queue is full.
+    bool Push(const tp_meter_frame& frame)
+    {
+        int start1, size1, start2, size2;
+        Fifo.prepareToWrite(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0) return false;
+        Frames[(0 < size1) ? start1 : start2] = frame;
+        Fifo.finishedWrite(1);
+        return true;
+    }
+
+    //R1.01 Editor thread. Returns false when there is nothing new.
+    bool Pop(tp_meter_frame& frame)
+    {
+        int start1, size1, start2, size2;
+        Fifo.prepareToRead(1, start1, size1, start2, size2);
+        if (size1 + size2 == 0) return false;
+        frame = Frames[(0 < size1) ? start1 : start2];
+        Fifo.finishedRead(1);
+        return true;
+    }
+
+private:
+    juce::AbstractFifo Fifo { Size };
+    tp_meter_frame Frames[Size];
+};
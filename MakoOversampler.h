@@ -0,0 +1,287 @@
+/*
+  ==============================================================================
+
+    MakoOversampler.h
+    R1.01 Polyphase half band oversampler for the drive section.
+
+    Each 2x stage is a Kaiser windowed half band FIR. Half of its coeffs are
+    zero and the centre tap is .5, so going up one branch is a short
+    symmetric FIR and the other branch is a plain delay. Going down works
+    the same way in reverse. Stages are chained for 4x and 8x.
+
+    All samples are MAKO_LANES interleaved floats, the same layout the
+    block engine uses, so every channel is filtered at once. More than
+    MAKO_LANES channels are run as groups of lanes, each group keeping
+    its own filter history.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "MakoSIMD.h"
+
+const int MAKO_OS_MAXSTAGES = 3;        //R1.01 3 stages is 8x.
+const int MAKO_OS_MAXPAIRS = 16;        //R1.01 Max non zero coeff pairs in one stage.
+const int MAKO_OS_MAXDELAY = 8;         //R1.01 Max latency padding, in oversampled samples.
+
+class MakoOversampler
+{
+public:
+    //R1.01 Allocate everything for 8x and numGroups lane groups. Call from prepareToPlay only.
+    void Prepare(int maxBlockSamples, int numGroups = 1)
+    {
+        BlockMax = maxBlockSamples;
+        Groups = (numGroups < 1) ? 1 : numGroups;
+        for (int s = 0; s < MAKO_OS_MAXSTAGES; s++)
+        {
+            //R1.01 The first stage works closest to the audio band so it gets the longest filter.
+            Stage_Design(Stage[s], (s == 0) ? 16 : 6);
+
+            int lowRate = BlockMax << s;
+            int H = 2 * Stage[s].Pairs - 1;
+            Stage[s].Hist.resize(size_t(Groups));
+            for (tp_history& hist : Stage[s].Hist)
+            {
+                hist.UpHist.assign(size_t(H + lowRate) * MAKO_LANES, 0.0f);
+                hist.DnEven.assign(size_t(H + lowRate) * MAKO_LANES, 0.0f);
+                hist.DnOdd.assign(size_t(Stage[s].Pairs + lowRate) * MAKO_LANES, 0.0f);
+            }
+        }
+        BufA.assign(size_t(BlockMax << MAKO_OS_MAXSTAGES) * MAKO_LANES, 0.0f);
+        BufB.assign(size_t(BlockMax << MAKO_OS_MAXSTAGES) * MAKO_LANES, 0.0f);
+        DelayHist.resize(size_t(Groups));
+        for (std::vector<float>& hist : DelayHist)
+            hist.assign(size_t(MAKO_OS_MAXDELAY + (BlockMax << MAKO_OS_MAXSTAGES)) * MAKO_LANES, 0.0f);
+    }
+
+    //R1.01 Factor must be 1, 2, 4 or 8. Changing it clears the filter histories.
+    void SetFactor(int factor)
+    {
+        Stages = 0;
+        while (((1 << Stages) < factor) && (Stages < MAKO_OS_MAXSTAGES)) Stages++;
+
+        //R1.01 The later stages add part of a host sample of delay. Pad with a few
+        //R1.01 oversampled samples so the total is a whole number of host samples.
+        double lat = 0.0;
+        for (int s = 0; s < Stages; s++) lat += double(2 * Stage[s].Pairs - 1) / double(1 << s);
+        Delay = int(std::lround((std::ceil(lat) - lat) * (1 << Stages)));
+        Latency = int(std::ceil(lat));
+        Reset();
+    }
+
+    int GetFactor() const { return 1 << Stages; }
+
+    //R1.01 Latency of going up and back down, in host samples.
+    int GetLatency() const { return Latency; }
+
+    void Reset()
+    {
+        for (int s = 0; s < MAKO_OS_MAXSTAGES; s++)
+        {
+            for (tp_history& hist : Stage[s].Hist)
+            {
+                std::fill(hist.UpHist.begin(), hist.UpHist.end(), 0.0f);
+                std::fill(hist.DnEven.begin(), hist.DnEven.end(), 0.0f);
+                std::fill(hist.DnOdd.begin(), hist.DnOdd.end(), 0.0f);
+            }
+        }
+        for (std::vector<float>& hist : DelayHist)
+            std::fill(hist.begin(), hist.end(), 0.0f);
+    }
+
+    //R1.01 Dual mono. True when the first numLanes lanes of a group's history are all within Level of lane 0.
+    //R1.01 Level 0 asks for exactly equal.
+    bool LanesMatch(int numLanes, float Level, int group = 0) const
+    {
+        for (int s = 0; s < Stages; s++)
+        {
+            const tp_history& hist = Stage[s].Hist[group];
+            const int H = 2 * Stage[s].Pairs - 1;
+            if (!Lanes_Match(hist.UpHist.data(), H, numLanes, Level)) return false;
+            if (!Lanes_Match(hist.DnEven.data(), H, numLanes, Level)) return false;
+            if (!Lanes_Match(hist.DnOdd.data(), Stage[s].Pairs, numLanes, Level)) return false;
+        }
+        return Lanes_Match(DelayHist[group].data(), Delay, numLanes, Level);
+    }
+
+    //R1.01 Copy lane 0's history to the next numLanes - 1 lanes of a group.
+    void LanesCopy(int numLanes, int group = 0)
+    {
+        for (int s = 0; s < Stages; s++)
+        {
+            tp_history& hist = Stage[s].Hist[group];
+            const int H = 2 * Stage[s].Pairs - 1;
+            Lanes_Copy(hist.UpHist.data(), H, numLanes);
+            Lanes_Copy(hist.DnEven.data(), H, numLanes);
+            Lanes_Copy(hist.DnOdd.data(), Stage[s].Pairs, numLanes);
+        }
+        Lanes_Copy(DelayHist[group].data(), Delay, numLanes);
+    }
+
+    //R1.01 Same for any lane interleaved buffer of frames samples (MAKO_LANES floats each).
+    static bool Lanes_Match(const float* data, int frames, int numLanes, float Level)
+    {
+        for (int i = 0; i < frames; i++)
+            for (int lane = 1; lane < numLanes; lane++)
+                if (Level < std::abs(data[i * MAKO_LANES + lane] - data[i * MAKO_LANES])) return false;
+        return true;
+    }
+
+    static void Lanes_Copy(float* data, int frames, int numLanes)
+    {
+        for (int i = 0; i < frames; i++)
+            for (int lane = 1; lane < numLanes; lane++)
+                data[i * MAKO_LANES + lane] = data[i * MAKO_LANES];
+    }
+
+    //R1.01 Upsample numSamples host samples. Returns the buffer holding numSamples * Factor samples.
+    //R1.01 The buffer is shared by all groups, so finish with one group (Down) before starting the next.
+    float* Up(const float* in, int numSamples, int group = 0)
+    {
+        const float* src = in;
+        float* dst = BufA.data();
+        for (int s = 0; s < Stages; s++)
+        {
+            Stage_Up(Stage[s], Stage[s].Hist[group], src, dst, numSamples << s);
+            src = dst;
+            dst = (dst == BufA.data()) ? BufB.data() : BufA.data();
+        }
+
+        //R1.01 Latency padding. History is kept in front of the new samples.
+        if (0 < Delay)
+        {
+            int n = (numSamples << Stages) * MAKO_LANES;
+            float* hist = DelayHist[group].data();
+            std::memcpy(hist + Delay * MAKO_LANES, src, sizeof(float) * size_t(n));
+            std::memcpy(const_cast<float*>(src), hist, sizeof(float) * size_t(n));
+            std::memmove(hist, hist + n, sizeof(float) * size_t(Delay) * MAKO_LANES);
+        }
+        return const_cast<float*>(src);
+    }
+
+    //R1.01 Downsample the buffer returned by Up back to numSamples host samples.
+    void Down(float* osData, float* out, int numSamples, int group = 0)
+    {
+        float* src = osData;
+        for (int s = Stages - 1; 0 <= s; s--)
+        {
+            float* dst = (s == 0) ? out : ((src == BufA.data()) ? BufB.data() : BufA.data());
+            Stage_Down(Stage[s], Stage[s].Hist[group], src, dst, numSamples << s);
+            src = dst;
+        }
+    }
+
+private:
+    struct tp_history {
+        std::vector<float> UpHist;          //R1.01 History + low rate input.
+        std::vector<float> DnEven;          //R1.01 History + even high rate samples.
+        std::vector<float> DnOdd;           //R1.01 History + odd high rate samples (the delay branch).
+    };
+
+    struct tp_halfband {
+        int Pairs = 0;
+        mako_f4 Coef[MAKO_OS_MAXPAIRS];     //R1.01 Side coeffs for going down.
+        mako_f4 Coef2[MAKO_OS_MAXPAIRS];    //R1.01 Same coeffs x2, going up makes up for the zero stuffing.
+        std::vector<tp_history> Hist;       //R1.01 One per lane group.
+    };
+
+    tp_halfband Stage[MAKO_OS_MAXSTAGES];
+    int Stages = 0;
+    int Groups = 1;
+    int BlockMax = 0;
+    int Delay = 0;
+    int Latency = 0;
+    std::vector<std::vector<float>> DelayHist;
+    std::vector<float> BufA;
+    std::vector<float> BufB;
+
+    static double Bessel_I0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < sum * 1e-12) break;
+        }
+        return sum;
+    }
+
+    static void Stage_Design(tp_halfband& hb, int pairs)
+    {
+        //R1.01 Ideal half band side taps are +-1/(pi*d) at odd offsets d. Kaiser window, beta 8 (~80 dB).
+        const double beta = 8.0;
+        const double len = 2.0 * pairs;
+        double c[MAKO_OS_MAXPAIRS] = {};
+        double sum = 0.0;
+        hb.Pairs = pairs;
+        for (int j = 1; j <= pairs; j++)
+        {
+            double d = 2.0 * j - 1.0;
+            double r = d / len;
+            double w = Bessel_I0(beta * std::sqrt(1.0 - r * r)) / Bessel_I0(beta);
+            c[j - 1] = (((j & 1) ? 1.0 : -1.0) / (3.14159265358979 * d)) * w;
+            sum += c[j - 1];
+        }
+
+        //R1.01 Scale so DC gain is exactly 1 (centre .5 + both sides).
+        for (int j = 0; j < pairs; j++)
+        {
+            float v = float(c[j] * (.25 / sum));
+            hb.Coef[j] = mako_set1(v);
+            hb.Coef2[j] = mako_set1(v * 2.0f);
+        }
+    }
+
+    static void Stage_Up(tp_halfband& hb, tp_history& hh, const float* in, float* out, int n)
+    {
+        //R1.01 out[2i] = FIR branch, out[2i+1] = delayed input.
+        const int K = hb.Pairs;
+        const int H = 2 * K - 1;
+        float* hist = hh.UpHist.data();
+        std::memcpy(hist + H * MAKO_LANES, in, sizeof(float) * size_t(n) * MAKO_LANES);
+
+        for (int i = 0; i < n; i++)
+        {
+            mako_f4 acc = mako_set1(0.0f);
+            for (int j = 1; j <= K; j++)
+                acc = acc + hb.Coef2[j - 1] * (mako_load(hist + (i + K - 1 + j) * MAKO_LANES) + mako_load(hist + (i + K - j) * MAKO_LANES));
+            mako_store(out + (2 * i) * MAKO_LANES, acc);
+            mako_store(out + (2 * i + 1) * MAKO_LANES, mako_load(hist + (i + K) * MAKO_LANES));
+        }
+
+        std::memmove(hist, hist + n * MAKO_LANES, sizeof(float) * size_t(H) * MAKO_LANES);
+    }
+
+    static void Stage_Down(tp_halfband& hb, tp_history& hh, const float* in, float* out, int n)
+    {
+        //R1.01 n is the number of LOW rate samples we make. Even inputs go thru the FIR, odd ones are delayed.
+        const int K = hb.Pairs;
+        const int H = 2 * K - 1;
+        float* even = hh.DnEven.data();
+        float* odd = hh.DnOdd.data();
+        const mako_f4 half = mako_set1(.5f);
+
+        for (int i = 0; i < n; i++)
+        {
+            mako_store(even + (H + i) * MAKO_LANES, mako_load(in + (2 * i) * MAKO_LANES));
+            mako_store(odd + (K + i) * MAKO_LANES, mako_load(in + (2 * i + 1) * MAKO_LANES));
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            mako_f4 acc = half * mako_load(odd + i * MAKO_LANES);
+            for (int j = 1; j <= K; j++)
+                acc = acc + hb.Coef[j - 1] * (mako_load(even + (i + K - 1 + j) * MAKO_LANES) + mako_load(even + (i + K - j) * MAKO_LANES));
+            mako_store(out + i * MAKO_LANES, acc);
+        }
+
+        std::memmove(even, even + n * MAKO_LANES, sizeof(float) * size_t(H) * MAKO_LANES);
+        std::memmove(odd, odd + n * MAKO_LANES, sizeof(float) * size_t(K) * MAKO_LANES);
+    }
+};
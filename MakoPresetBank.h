@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    MakoPresetBank.h
+    R1.01 Preset banks in a small binary file.
+
+    File layout, all little endian:
+      Header, 16 bytes:
+        char[4]  Magic "MKOB"
+        uint16   Version (MAKO_BANK_VERSION)
+        uint16   ParmCount, values per preset
+        uint32   Count, presets in the file
+        uint32   RecordSize, bytes per preset (MAKO_BANK_NAMELEN + 4 * ParmCount)
+      Then Count records, each:
+        char[MAKO_BANK_NAMELEN]  Name, UTF-8, zero padded
+        float[ParmCount]         Values in parameter units (Hz, 0-1, ...), in e_ order
+
+    Every record is the same size, so preset N is at 16 + N * RecordSize and
+    the file can be memory mapped and read in place. Newer versions may add
+    parameters at the end of a record. Readers use the ones they know and
+    take defaults for any the file does not have.
+
+    The processor copies a bank into RAM when it loads it, so the audio
+    thread never touches the file (a mapped page could need a disk read).
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+
+const int MAKO_BANK_VERSION = 1;
+const int MAKO_BANK_NAMELEN = 24;
+const int MAKO_BANK_HEADER = 16;
+const int MAKO_BANK_MAXPRESETS = 1 << 16;   //R1.01 512 MIDI banks of 128.
+
+class MakoPresetBank
+{
+public:
+    explicit MakoPresetBank(int parmCount = 0) : Parms(parmCount) {}
+
+    int Count() const { return Names.size(); }
+    int ParmCount() const { return Parms; }
+    juce::String Name(int idx) const { return Names[idx]; }
+    void SetName(int idx, const juce::String& name) { Names.set(idx, name); }
+
+    //R1.01 Values for preset idx, ParmCount floats. Safe on the audio thread, just a pointer.
+    const float* Values(int idx) const { return &Value[size_t(idx) * size_t(Parms)]; }
+
+    void Add(const juce::String& name, const float* values)
+    {
+        Names.add(name);
+        Value.insert(Value.end(), values, values + Parms);
+    }
+
+    //R1.01 Read a bank image (a mapped file or memory). Values the file does not have come from Defaults.
+    bool Read(const void* data, size_t size, const float* Defaults, juce::String& error)
+    {
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        if ((size < size_t(MAKO_BANK_HEADER)) || (std::memcmp(src, "MKOB", 4) != 0))
+        {
+            error = "Not a MakoOD preset bank.";
+            return false;
+        }
+
+        int Version = Read_U16(src + 4);
+        int FileParms = Read_U16(src + 6);
+        uint32_t FileCount = Read_U32(src + 8);
+        uint32_t RecordSize = Read_U32(src + 12);
+        if ((Version < 1) || (RecordSize < uint32_t(MAKO_BANK_NAMELEN + 4 * FileParms)) || (uint32_t(MAKO_BANK_MAXPRESETS) < FileCount)
+            || (size < size_t(MAKO_BANK_HEADER) + size_t(FileCount) * RecordSize))
+        {
+            error = "Preset bank is damaged or from an unknown version.";
+            return false;
+        }
+
+        Names.clearQuick();
+        Value.clear();
+        Value.reserve(size_t(FileCount) * size_t(Parms));
+        std::vector<float> Rec(size_t(Parms), 0.0f);
+        for (uint32_t p = 0; p < FileCount; p++)
+        {
+            const uint8_t* rec = src + MAKO_BANK_HEADER + size_t(p) * RecordSize;
+            char name[MAKO_BANK_NAMELEN + 1] = {};
+            std::memcpy(name, rec, MAKO_BANK_NAMELEN);
+            for (int t = 0; t < Parms; t++)
+                Rec[size_t(t)] = (t < FileParms) ? Read_F32(rec + MAKO_BANK_NAMELEN + 4 * t) : Defaults[t];
+            Add(juce::String::fromUTF8(name), Rec.data());
+        }
+        return true;
+    }
+
+    bool ReadFile(const juce::File& file, const float* Defaults, juce::String& error)
+    {
+        juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+        if (mapped.getData() == nullptr)
+        {
+            error = "Can not open " + file.getFullPathName();
+            return false;
+        }
+        return Read(mapped.getData(), mapped.getSize(), Defaults, error);
+    }
+
+    //R1.01 Build the file image.
+    juce::MemoryBlock Write() const
+    {
+        const uint32_t RecordSize = uint32_t(MAKO_BANK_NAMELEN + 4 * Parms);
+        juce::MemoryBlock out(size_t(MAKO_BANK_HEADER) + size_t(Count()) * RecordSize, true);
+        uint8_t* dst = static_cast<uint8_t*>(out.getData());
+        std::memcpy(dst, "MKOB", 4);
+        Write_U16(dst + 4, MAKO_BANK_VERSION);
+        Write_U16(dst + 6, Parms);
+        Write_U32(dst + 8, uint32_t(Count()));
+        Write_U32(dst + 12, RecordSize);
+        for (int p = 0; p < Count(); p++)
+        {
+            uint8_t* rec = dst + MAKO_BANK_HEADER + size_t(p) * RecordSize;
+            juce::String name = Names[p];
+            while (MAKO_BANK_NAMELEN <= int(std::strlen(name.toRawUTF8()))) name = name.dropLastCharacters(1);
+            std::memcpy(rec, name.toRawUTF8(), std::strlen(name.toRawUTF8()));
+            for (int t = 0; t < Parms; t++) Write_F32(rec + MAKO_BANK_NAMELEN + 4 * t, Values(p)[t]);
+        }
+        return out;
+    }
+
+    bool WriteFile(const juce::File& file) const
+    {
+        juce::MemoryBlock data = Write();
+        return file.replaceWithData(data.getData(), data.getSize());
+    }
+
+private:
+    int Parms = 0;
+    juce::StringArray Names;
+    std::vector<float> Value;       //R1.01 Count x Parms, preset after preset.
+
+    static int Read_U16(const uint8_t* p) { return int(p[0]) | (int(p[1]) << 8); }
+    static uint32_t Read_U32(const uint8_t* p) { return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24); }
+    static float Read_F32(const uint8_t* p) { uint32_t u = Read_U32(p); float f; std::memcpy(&f, &u, 4); return f; }
+    static void Write_U16(uint8_t* p, int v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+    static void Write_U32(uint8_t* p, uint32_t v) { for (int t = 0; t < 4; t++) p[t] = uint8_t(v >> (8 * t)); }
+    static void Write_F32(uint8_t* p, float f) { uint32_t u; std::memcpy(&u, &f, 4); Write_U32(p, u); }
+};
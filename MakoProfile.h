@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    MakoProfile.h
+    R1.01 Optional per stage CPU timing for processBlock.
+
+    Build with MAKO_PROFILE=1 to turn it on. Otherwise the macros below are
+    empty and the processor has no profiler at all.
+
+    Each stage adds up its ticks over a block (x86 cycle counter, or
+    nanoseconds on other CPUs). At the end of processBlock every stage
+    that ran gets one entry: block count, total, worst block and a log2
+    histogram of ticks per block. Everything is a relaxed atomic written
+    only by the audio thread, so the editor and tools can read it at any
+    time. A reading may mix two blocks, which is fine for a profile.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+ #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+ #include <x86intrin.h>
+#endif
+
+#ifndef MAKO_PROFILE
+ #define MAKO_PROFILE 0
+#endif
+
+//R1.01 Stages. The block engine fuses Low filter + gate into one loop and EnhHigh, High,
+//R1.01 Drive, blend and EnhLow into another, so those are timed as one stage each.
+const int MAKO_PROF_SETTINGS = 0;   //R1.01 Parameter snapshot, coeff updates, ramps, quality change.
+const int MAKO_PROF_LOWGATE = 1;    //R1.01 Low filter and noise gate.
+const int MAKO_PROF_OSUP = 2;       //R1.01 Oversampling up.
+const int MAKO_PROF_CORE = 3;       //R1.01 EnhHigh, High, Drive, blend, EnhLow.
+const int MAKO_PROF_OSDOWN = 4;     //R1.01 Oversampling down.
+const int MAKO_PROF_CLIP = 5;       //R1.01 Volume and clip.
+const int MAKO_PROF_RATE = 6;       //R1.01 Internal rate resampler, both ways.
+const int MAKO_PROF_BLOCK = 7;      //R1.01 All of processBlock. Ending this stage ends the block.
+const int MAKO_PROF_STAGES = 8;
+const int MAKO_PROF_BINS = 24;      //R1.01 Histogram bin b counts blocks of 2^(b+6) to 2^(b+7) ticks.
+const int MAKO_PROF_BINSHIFT = 6;
+
+//R1.01 A cheap tick counter. Cycles on x86, nanoseconds everywhere else.
+inline uint64_t mako_ticks()
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    return uint64_t(__rdtsc());
+#else
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+class MakoProfiler
+{
+public:
+    MakoProfiler() { Reset(); }
+
+    //R1.01 Clear everything. Not while processBlock is running (prepareToPlay or a tool between runs).
+    void Reset()
+    {
+        for (int s = 0; s < MAKO_PROF_STAGES; s++)
+        {
+            Acc[s] = 0;
+            Stage[s].Blocks.store(0, std::memory_order_relaxed);
+            Stage[s].Total.store(0, std::memory_order_relaxed);
+            Stage[s].Max.store(0, std::memory_order_relaxed);
+            for (int b = 0; b < MAKO_PROF_BINS; b++) Stage[s].Hist[b].store(0, std::memory_order_relaxed);
+        }
+        Start_Ticks = mako_ticks();
+        Start_Time = std::chrono::steady_clock::now();
+    }
+
+    //R1.01 Audio thread.
+    void Add(int stage, uint64_t ticks)
+    {
+        Acc[stage] += ticks;
+        if (stage == MAKO_PROF_BLOCK) EndBlock();
+    }
+
+    //R1.01 Ticks per microsecond, measured against the steady clock since the last Reset.
+    double TicksPerUs() const
+    {
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - Start_Time).count();
+        if (us < 1000.0) return TicksFallback;
+        return double(mako_ticks() - Start_Ticks) / us;
+    }
+
+    uint64_t Blocks(int stage) const { return Stage[stage].Blocks.load(std::memory_order_relaxed); }
+
+    //R1.01 Average and worst microseconds per block the stage ran in.
+    double AvgUs(int stage) const
+    {
+        uint64_t n = Blocks(stage);
+        return (n == 0) ? 0.0 : double(Stage[stage].Total.load(std::memory_order_relaxed)) / double(n) / TicksPerUs();
+    }
+    double MaxUs(int stage) const { return double(Stage[stage].Max.load(std::memory_order_relaxed)) / TicksPerUs(); }
+
+    //R1.01 Percentile (0-1) from the histogram. Returns the top edge of the bin it lands in (never more than
+    //R1.01 the worst block), so it is within 2x.
+    double PercentileUs(int stage, double p) const
+    {
+        uint64_t n = Blocks(stage);
+        if (n == 0) return 0.0;
+        uint64_t want = uint64_t(std::ceil(double(n) * p));
+        uint64_t sum = 0;
+        int b = 0;
+        for (; b < MAKO_PROF_BINS - 1; b++)
+        {
+            sum += Stage[stage].Hist[b].load(std::memory_order_relaxed);
+            if (want <= sum) break;
+        }
+        uint64_t edge = uint64_t(1) << (b + MAKO_PROF_BINSHIFT + 1);
+        return double(std::min(edge, Stage[stage].Max.load(std::memory_order_relaxed))) / TicksPerUs();
+    }
+
+    static const char* StageName(int stage)
+    {
+        static const char* Names[MAKO_PROF_STAGES] = { "settings", "lowgate", "osup", "core", "osdown", "clip", "rate", "block" };
+        return Names[stage];
+    }
+
+    //R1.01 One line for the editor: average microseconds per block for each stage that ran.
+    juce::String Summary() const
+    {
+        juce::String text;
+        for (int s = 0; s < MAKO_PROF_STAGES; s++)
+        {
+            if (Blocks(s) == 0) continue;
+            text += juce::String(StageName(s)) + " " + juce::String(AvgUs(s), 1) + "  ";
+        }
+        if (0 < Blocks(MAKO_PROF_BLOCK)) text += "(max " + juce::String(MaxUs(MAKO_PROF_BLOCK), 1) + ") us";
+        return text;
+    }
+
+    //R1.01 One row per stage for tools. See RowHeader for the CSV columns.
+    static juce::String RowHeader() { return "stage,blocks,avg_us,p50_us,p99_us,max_us,share,ticks_per_us,hist"; }
+    juce::String Row(int stage, bool json) const
+    {
+        uint64_t all = Stage[MAKO_PROF_BLOCK].Total.load(std::memory_order_relaxed);
+        double share = (all == 0) ? 0.0 : double(Stage[stage].Total.load(std::memory_order_relaxed)) / double(all);
+        juce::String hist;
+        for (int b = 0; b < MAKO_PROF_BINS; b++)
+            hist += ((b == 0) ? "" : (json ? "," : ";")) + juce::String(juce::int64(Stage[stage].Hist[b].load(std::memory_order_relaxed)));
+
+        if (json)
+            return "\"stage\": \"" + juce::String(StageName(stage)) + "\", \"blocks\": " + juce::String(juce::int64(Blocks(stage)))
+                 + ", \"avg_us\": " + juce::String(AvgUs(stage), 3) + ", \"p50_us\": " + juce::String(PercentileUs(stage, .5), 3)
+                 + ", \"p99_us\": " + juce::String(PercentileUs(stage, .99), 3) + ", \"max_us\": " + juce::String(MaxUs(stage), 3)
+                 + ", \"share\": " + juce::String(share, 4) + ", \"ticks_per_us\": " + juce::String(TicksPerUs(), 1) + ", \"hist\": [" + hist + "]";
+
+        return juce::String(StageName(stage)) + "," + juce::String(juce::int64(Blocks(stage))) + "," + juce::String(AvgUs(stage), 3)
+             + "," + juce::String(PercentileUs(stage, .5), 3) + "," + juce::String(PercentileUs(stage, .99), 3) + "," + juce::String(MaxUs(stage), 3)
+             + "," + juce::String(share, 4) + "," + juce::String(TicksPerUs(), 1) + "," + hist;
+    }
+
+private:
+    struct tp_stage {
+        std::atomic<uint64_t> Blocks;
+        std::atomic<uint64_t> Total;
+        std::atomic<uint64_t> Max;
+        std::atomic<uint32_t> Hist[MAKO_PROF_BINS];
+    };
+
+    //R1.01 Used until enough time has passed to measure the tick rate. About right for x86, exact for nanoseconds.
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || defined(__i386__)
+    static constexpr double TicksFallback = 3000.0;
+#else
+    static constexpr double TicksFallback = 1000.0;
+#endif
+
+    uint64_t Acc[MAKO_PROF_STAGES];     //R1.01 This block so far. Audio thread only.
+    tp_stage Stage[MAKO_PROF_STAGES];
+    uint64_t Start_Ticks = 0;
+    std::chrono::steady_clock::time_point Start_Time;
+
+    void EndBlock()
+    {
+        //R1.01 Single writer, so plain load + store is enough (no locked read-modify-write).
+        for (int s = 0; s < MAKO_PROF_STAGES; s++)
+        {
+            uint64_t t = Acc[s];
+            if (t == 0) continue;
+            Acc[s] = 0;
+
+            tp_stage& st = Stage[s];
+            st.Blocks.store(st.Blocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            st.Total.store(st.Total.load(std::memory_order_relaxed) + t, std::memory_order_relaxed);
+            if (st.Max.load(std::memory_order_relaxed) < t) st.Max.store(t, std::memory_order_relaxed);
+
+            int b = 0;
+            while ((b < MAKO_PROF_BINS - 1) && ((uint64_t(1) << (b + MAKO_PROF_BINSHIFT + 1)) <= t)) b++;
+            st.Hist[b].store(st.Hist[b].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    }
+};
+
+//R1.01 Times a whole processBlock, however it returns.
+class MakoProfileBlock
+{
+public:
+    explicit MakoProfileBlock(MakoProfiler& prof) : Prof(prof), Start(mako_ticks()) {}
+    ~MakoProfileBlock() { Prof.Add(MAKO_PROF_BLOCK, mako_ticks() - Start); }
+
+private:
+    MakoProfiler& Prof;
+    uint64_t Start;
+};
+
+//R1.01 Timing macros for processor code. They expect a MakoProfiler named Profile in scope
+//R1.01 and compile to nothing unless MAKO_PROFILE is set.
+#if MAKO_PROFILE
+ #define MAKO_PROF_BLOCK_SCOPE()        MakoProfileBlock makoProfBlock(Profile)
+ #define MAKO_PROF_START(name)          const uint64_t name = mako_ticks()
+ #define MAKO_PROF_STOP(name, stage)    Profile.Add(stage, mako_ticks() - name)
+#else
+ #define MAKO_PROF_BLOCK_SCOPE()
+ #define MAKO_PROF_START(name)
+ #define MAKO_PROF_STOP(name, stage)
+#endif
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    MakoSIMD.h
+    R1.01 A tiny 4 lane float type for the block audio engine.
+    Each lane holds one audio channel, so stereo uses lanes 0 and 1.
+    SSE is used on x86/x64, NEON on ARM, and plain floats anywhere else.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+ #define MAKO_SIMD_SSE 1
+ #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+ #define MAKO_SIMD_NEON 1
+ #include <arm_neon.h>
+#else
+ #define MAKO_SIMD_SCALAR 1
+#endif
+
+//R1.01 Number of channels we can process side by side in one register.
+const int MAKO_LANES = 4;
+
+//R1.01 Our 4 lane float. Masks (compare results) are stored in the same type.
+struct mako_f4
+{
+#if MAKO_SIMD_SSE
+    __m128 v;
+#elif MAKO_SIMD_NEON
+    float32x4_t v;
+#else
+    float v[4];
+#endif
+};
+
+#if MAKO_SIMD_SSE
+
+inline mako_f4 mako_set1(float a)                       { return { _mm_set1_ps(a) }; }
+inline mako_f4 mako_load(const float* p)                { return { _mm_loadu_ps(p) }; }
+inline void    mako_store(float* p, mako_f4 a)          { _mm_storeu_ps(p, a.v); }
+inline mako_f4 operator+(mako_f4 a, mako_f4 b)          { return { _mm_add_ps(a.v, b.v) }; }
+inline mako_f4 operator-(mako_f4 a, mako_f4 b)          { return { _mm_sub_ps(a.v, b.v) }; }
+inline mako_f4 operator*(mako_f4 a, mako_f4 b)          { return { _mm_mul_ps(a.v, b.v) }; }
+inline mako_f4 mako_div(mako_f4 a, mako_f4 b)           { return { _mm_div_ps(a.v, b.v) }; }
+inline mako_f4 mako_min(mako_f4 a, mako_f4 b)           { return { _mm_min_ps(a.v, b.v) }; }
+inline mako_f4 mako_max(mako_f4 a, mako_f4 b)           { return { _mm_max_ps(a.v, b.v) }; }
+inline mako_f4 mako_abs(mako_f4 a)                      { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+inline mako_f4 mako_copysign(mako_f4 a, mako_f4 s)      { return { _mm_or_ps(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v), _mm_and_ps(_mm_set1_ps(-0.0f), s.v)) }; }
+inline mako_f4 mako_lt(mako_f4 a, mako_f4 b)            { return { _mm_cmplt_ps(a.v, b.v) }; }
+inline mako_f4 mako_or(mako_f4 a, mako_f4 b)            { return { _mm_or_ps(a.v, b.v) }; }
+inline mako_f4 mako_select(mako_f4 m, mako_f4 a, mako_f4 b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+inline bool    mako_any(mako_f4 m)                      { return _mm_movemask_ps(m.v) != 0; }
+
+#elif MAKO_SIMD_NEON
+
+inline mako_f4 mako_set1(float a)                       { return { vdupq_n_f32(a) }; }
+inline mako_f4 mako_load(const float* p)                { return { vld1q_f32(p) }; }
+inline void    mako_store(float* p, mako_f4 a)          { vst1q_f32(p, a.v); }
+inline mako_f4 operator+(mako_f4 a, mako_f4 b)          { return { vaddq_f32(a.v, b.v) }; }
+inline mako_f4 operator-(mako_f4 a, mako_f4 b)          { return { vsubq_f32(a.v, b.v) }; }
+inline mako_f4 operator*(mako_f4 a, mako_f4 b)          { return { vmulq_f32(a.v, b.v) }; }
+#if defined(__aarch64__) || defined(_M_ARM64)
+inline mako_f4 mako_div(mako_f4 a, mako_f4 b)           { return { vdivq_f32(a.v, b.v) }; }
+#else
+//R1.01 32 bit ARM has no divide. Reciprocal estimate plus two Newton steps is close to full float.
+inline mako_f4 mako_div(mako_f4 a, mako_f4 b)           { float32x4_t r = vrecpeq_f32(b.v); r = vmulq_f32(vrecpsq_f32(b.v, r), r); r = vmulq_f32(vrecpsq_f32(b.v, r), r); return { vmulq_f32(a.v, r) }; }
+#endif
+inline mako_f4 mako_min(mako_f4 a, mako_f4 b)           { return { vminq_f32(a.v, b.v) }; }
+inline mako_f4 mako_max(mako_f4 a, mako_f4 b)           { return { vmaxq_f32(a.v, b.v) }; }
+inline mako_f4 mako_abs(mako_f4 a)                      { return { vabsq_f32(a.v) }; }
+inline mako_f4 mako_copysign(mako_f4 a, mako_f4 s)      { return { vbslq_f32(vdupq_n_u32(0x80000000u), s.v, a.v) }; }
+inline mako_f4 mako_lt(mako_f4 a, mako_f4 b)            { return { vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)) }; }
+inline mako_f4 mako_or(mako_f4 a, mako_f4 b)            { return { vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a.v), vreinterpretq_u32_f32(b.v))) }; }
+inline mako_f4 mako_select(mako_f4 m, mako_f4 a, mako_f4 b) { return { vbslq_f32(vreinterpretq_u32_f32(m.v), a.v, b.v) }; }
+inline bool    mako_any(mako_f4 m)                      { uint32x4_t u = vreinterpretq_u32_f32(m.v); return (vgetq_lane_u32(u, 0) | vgetq_lane_u32(u, 1) | vgetq_lane_u32(u, 2) | vgetq_lane_u32(u, 3)) != 0; }
+
+#else
+
+//R1.01 Plain C++ fallback. Masks are 1.0f (true) or 0.0f (false) per lane.
+inline mako_f4 mako_set1(float a)                       { return { { a, a, a, a } }; }
+inline mako_f4 mako_load(const float* p)                { return { { p[0], p[1], p[2], p[3] } }; }
+inline void    mako_store(float* p, mako_f4 a)          { for (int t = 0; t < 4; t++) p[t] = a.v[t]; }
+inline mako_f4 operator+(mako_f4 a, mako_f4 b)          { for (int t = 0; t < 4; t++) a.v[t] += b.v[t]; return a; }
+inline mako_f4 operator-(mako_f4 a, mako_f4 b)          { for (int t = 0; t < 4; t++) a.v[t] -= b.v[t]; return a; }
+inline mako_f4 operator*(mako_f4 a, mako_f4 b)          { for (int t = 0; t < 4; t++) a.v[t] *= b.v[t]; return a; }
+inline mako_f4 mako_div(mako_f4 a, mako_f4 b)           { for (int t = 0; t < 4; t++) a.v[t] /= b.v[t]; return a; }
+inline mako_f4 mako_min(mako_f4 a, mako_f4 b)           { for (int t = 0; t < 4; t++) a.v[t] = (b.v[t] < a.v[t]) ? b.v[t] : a.v[t]; return a; }
+inline mako_f4 mako_max(mako_f4 a, mako_f4 b)           { for (int t = 0; t < 4; t++) a.v[t] = (a.v[t] < b.v[t]) ? b.v[t] : a.v[t]; return a; }
+inline mako_f4 mako_abs(mako_f4 a)                      { for (int t = 0; t < 4; t++) a.v[t] = std::fabs(a.v[t]); return a; }
+inline mako_f4 mako_copysign(mako_f4 a, mako_f4 s)      { for (int t = 0; t < 4; t++) a.v[t] = std::copysign(a.v[t], s.v[t]); return a; }
+inline mako_f4 mako_lt(mako_f4 a, mako_f4 b)            { for (int t = 0; t < 4; t++) a.v[t] = (a.v[t] < b.v[t]) ? 1.0f : 0.0f; return a; }
+inline mako_f4 mako_or(mako_f4 a, mako_f4 b)            { for (int t = 0; t < 4; t++) a.v[t] = (a.v[t] != 0.0f || b.v[t] != 0.0f) ? 1.0f : 0.0f; return a; }
+inline mako_f4 mako_select(mako_f4 m, mako_f4 a, mako_f4 b) { for (int t = 0; t < 4; t++) a.v[t] = (m.v[t] != 0.0f) ? a.v[t] : b.v[t]; return a; }
+inline bool    mako_any(mako_f4 m)                      { return (m.v[0] != 0.0f) || (m.v[1] != 0.0f) || (m.v[2] != 0.0f) || (m.v[3] != 0.0f); }
+
+#endif
+
+//R1.01 Apply a scalar function to each lane. Only for things that have no SIMD version.
+template <typename Func>
+inline mako_f4 mako_map(mako_f4 a, Func fn)
+{
+    float tmp[MAKO_LANES];
+    mako_store(tmp, a);
+    for (int t = 0; t < MAKO_LANES; t++) tmp[t] = fn(tmp[t]);
+    return mako_load(tmp);
+}
@@ -0,0 +1,206 @@
+/*
+  ==============================================================================
+
+    MakoTanh.h
+    R1.01 Fast tanh approximations for the shaper stages.
+
+    Every tier has a scalar and a 4 lane (mako_f4) version that give the
+    same results. Pick a tier at build time with MAKO_TANH_TIER or at run
+    time with the processor's Tanh_Tier var.
+
+    Measured over |x| <= 10 (error vs double precision tanh) on an x64 SSE2
+    build (g++ -O2, best of 3 runs on a shared VM, so treat the timings as
+    ratios more than absolutes):
+
+      Tier        Max error    ns/sample (4 lanes)   ns/sample (scalar)
+      Exact        1.0e-07         14.5                   14.0
+      Rational     3.9e-07          1.05                   3.5
+      Piecewise    2.6e-06          2.6                    4.4
+      Clamped      2.4e-02          0.44                   1.35
+
+    Exact is the C library tanhf, one lane at a time. Use it to check the
+    others, not for speed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include "MakoSIMD.h"
+
+const int MAKO_TANH_EXACT = 0;        //R1.01 tanhf from the C library.
+const int MAKO_TANH_RATIONAL = 1;     //R1.01 13/6 minimax rational. About float accuracy.
+const int MAKO_TANH_PIECEWISE = 2;    //R1.01 Cubic Hermite pieces from a small table.
+const int MAKO_TANH_CLAMPED = 3;      //R1.01 3/2 Pade, input clamped to +-3. Cheapest, ~2% error.
+const int MAKO_TANH_TIERS = 4;
+
+#ifndef MAKO_TANH_TIER
+ #define MAKO_TANH_TIER MAKO_TANH_RATIONAL
+#endif
+
+//==============================================================================
+//R1.01 RATIONAL. Odd 13th order numerator over even 6th order denominator.
+//R1.01 Past +-7.9 tanh is 1.0f in float anyway, so the input is clamped there.
+//==============================================================================
+const float MakoTanh_RatClamp = 7.90531110763549805f;
+const float MakoTanh_RatA1 = 4.89352455891786e-03f;
+const float MakoTanh_RatA3 = 6.37261928875436e-04f;
+const float MakoTanh_RatA5 = 1.48572235717979e-05f;
+const float MakoTanh_RatA7 = 5.12229709037114e-08f;
+const float MakoTanh_RatA9 = -8.60467152213735e-11f;
+const float MakoTanh_RatA11 = 2.00018790482477e-13f;
+const float MakoTanh_RatA13 = -2.76076847742355e-16f;
+const float MakoTanh_RatB0 = 4.89352518554385e-03f;
+const float MakoTanh_RatB2 = 2.26843463243900e-03f;
+const float MakoTanh_RatB4 = 1.18534705686654e-04f;
+const float MakoTanh_RatB6 = 1.19825839466702e-06f;
+
+inline float MakoTanh_Rational(float x)
+{
+    x = (x < -MakoTanh_RatClamp) ? -MakoTanh_RatClamp : ((MakoTanh_RatClamp < x) ? MakoTanh_RatClamp : x);
+    float x2 = x * x;
+    float p = MakoTanh_RatA13;
+    p = p * x2 + MakoTanh_RatA11;
+    p = p * x2 + MakoTanh_RatA9;
+    p = p * x2 + MakoTanh_RatA7;
+    p = p * x2 + MakoTanh_RatA5;
+    p = p * x2 + MakoTanh_RatA3;
+    p = p * x2 + MakoTanh_RatA1;
+    float q = MakoTanh_RatB6;
+    q = q * x2 + MakoTanh_RatB4;
+    q = q * x2 + MakoTanh_RatB2;
+    q = q * x2 + MakoTanh_RatB0;
+    return (x * p) / q;
+}
+
+inline mako_f4 MakoTanh_Rational(mako_f4 x)
+{
+    x = mako_max(mako_min(x, mako_set1(MakoTanh_RatClamp)), mako_set1(-MakoTanh_RatClamp));
+    mako_f4 x2 = x * x;
+    mako_f4 p = mako_set1(MakoTanh_RatA13);
+    p = p * x2 + mako_set1(MakoTanh_RatA11);
+    p = p * x2 + mako_set1(MakoTanh_RatA9);
+    p = p * x2 + mako_set1(MakoTanh_RatA7);
+    p = p * x2 + mako_set1(MakoTanh_RatA5);
+    p = p * x2 + mako_set1(MakoTanh_RatA3);
+    p = p * x2 + mako_set1(MakoTanh_RatA1);
+    mako_f4 q = mako_set1(MakoTanh_RatB6);
+    q = q * x2 + mako_set1(MakoTanh_RatB4);
+    q = q * x2 + mako_set1(MakoTanh_RatB2);
+    q = q * x2 + mako_set1(MakoTanh_RatB0);
+    return mako_div(x * p, q);
+}
+
+//==============================================================================
+//R1.01 PIECEWISE. Cubic Hermite between knots every 1/8 on 0..8, using the exact
+//R1.01 value and slope at each knot. tanh is odd, so only positive x is stored.
+//==============================================================================
+const int MakoTanh_PwKnots = 65;
+const float MakoTanh_PwStep = 8.0f;           //R1.01 Knots per 1.0 of input.
+const float MakoTanh_PwMax = 8.0f;
+
+struct tp_tanh_table
+{
+    float Val[MakoTanh_PwKnots];
+    float Slope[MakoTanh_PwKnots];    //R1.01 Already scaled by the knot spacing.
+
+    tp_tanh_table()
+    {
+        for (int t = 0; t < MakoTanh_PwKnots; t++)
+        {
+            double v = std::tanh(double(t) / MakoTanh_PwStep);
+            Val[t] = float(v);
+            Slope[t] = float((1.0 - v * v) / MakoTanh_PwStep);
+        }
+    }
+};
+
+inline const tp_tanh_table& MakoTanh_Table()
+{
+    static const tp_tanh_table table;
+    return table;
+}
+
+inline float MakoTanh_Piecewise(float x)
+{
+    const tp_tanh_table& tb = MakoTanh_Table();
+    //R1.01 Written so a NaN fails the test and gets clamped too, like mako_min in the SIMD version.
+    //R1.01 int() of a NaN is undefined.
+    float ax = std::fabs(x);
+    ax = (ax < MakoTanh_PwMax - .0001f) ? ax : MakoTanh_PwMax - .0001f;
+    float pos = ax * MakoTanh_PwStep;
+    int idx = int(pos);
+    float t = pos - float(idx);
+
+    //R1.01 Hermite basis written as a cubic in t.
+    float p0 = tb.Val[idx], p1 = tb.Val[idx + 1];
+    float m0 = tb.Slope[idx], m1 = tb.Slope[idx + 1];
+    float c2 = 3.0f * (p1 - p0) - 2.0f * m0 - m1;
+    float c3 = 2.0f * (p0 - p1) + m0 + m1;
+    float y = ((c3 * t + c2) * t + m0) * t + p0;
+    return (x < 0.0f) ? -y : y;
+}
+
+inline mako_f4 MakoTanh_Piecewise(mako_f4 x)
+{
+    //R1.01 No gather on SSE2/NEON, so the table reads are done one lane at a time.
+    const tp_tanh_table& tb = MakoTanh_Table();
+    mako_f4 ax = mako_min(mako_abs(x), mako_set1(MakoTanh_PwMax - .0001f));
+    mako_f4 pos = ax * mako_set1(MakoTanh_PwStep);
+    float lanePos[MAKO_LANES];
+    float p0[MAKO_LANES], p1[MAKO_LANES], m0[MAKO_LANES], m1[MAKO_LANES], fr[MAKO_LANES];
+    mako_store(lanePos, pos);
+    for (int t = 0; t < MAKO_LANES; t++)
+    {
+        int idx = int(lanePos[t]);
+        fr[t] = lanePos[t] - float(idx);
+        p0[t] = tb.Val[idx];
+        p1[t] = tb.Val[idx + 1];
+        m0[t] = tb.Slope[idx];
+        m1[t] = tb.Slope[idx + 1];
+    }
+    mako_f4 vP0 = mako_load(p0), vP1 = mako_load(p1), vM0 = mako_load(m0), vM1 = mako_load(m1), t = mako_load(fr);
+    mako_f4 c2 = mako_set1(3.0f) * (vP1 - vP0) - mako_set1(2.0f) * vM0 - vM1;
+    mako_f4 c3 = mako_set1(2.0f) * (vP0 - vP1) + vM0 + vM1;
+    mako_f4 y = ((c3 * t + c2) * t + vM0) * t + vP0;
+    return mako_copysign(y, x);
+}
+
+//==============================================================================
+//R1.01 CLAMPED. x(27 + x^2) / (27 + 9x^2) hits exactly 1.0 at x = 3, so clamp there.
+//==============================================================================
+inline float MakoTanh_Clamped(float x)
+{
+    x = (x < -3.0f) ? -3.0f : ((3.0f < x) ? 3.0f : x);
+    float x2 = x * x;
+    return x * (27.0f + x2) / (27.0f + 9.0f * x2);
+}
+
+inline mako_f4 MakoTanh_Clamped(mako_f4 x)
+{
+    x = mako_max(mako_min(x, mako_set1(3.0f)), mako_set1(-3.0f));
+    mako_f4 x2 = x * x;
+    return mako_div(x * (mako_set1(27.0f) + x2), mako_set1(27.0f) + mako_set1(9.0f) * x2);
+}
+
+//==============================================================================
+//R1.01 Tier selection. Tier is a template arg so the choice is made once per block.
+//==============================================================================
+template <int Tier>
+inline float MakoTanh(float x)
+{
+    if (Tier == MAKO_TANH_RATIONAL) return MakoTanh_Rational(x);
+    if (Tier == MAKO_TANH_PIECEWISE) return MakoTanh_Piecewise(x);
+    if (Tier == MAKO_TANH_CLAMPED) return MakoTanh_Clamped(x);
+    return tanhf(x);
+}
+
+template <int Tier>
+inline mako_f4 MakoTanh(mako_f4 x)
+{
+    if (Tier == MAKO_TANH_RATIONAL) return MakoTanh_Rational(x);
+    if (Tier == MAKO_TANH_PIECEWISE) return MakoTanh_Piecewise(x);
+    if (Tier == MAKO_TANH_CLAMPED) return MakoTanh_Clamped(x);
+    return mako_map(x, tanhf);
+}
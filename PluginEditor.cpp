@@ -26,14 +26,14 @@ MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcess
     //****************************************************************************************
     //R1.00 Add GUI CONTROLS
     //****************************************************************************************
-    GUI_Init_Large_Slider(&sldKnob[e_Gain], audioProcessor.Setting[e_Gain], 0.0f, 2.0f, .01f, ""); 
-    GUI_Init_Large_Slider(&sldKnob[e_NGate], audioProcessor.Setting[e_NGate], 0.0f, 1.0f, .01f, "");
-    GUI_Init_Large_Slider(&sldKnob[e_Low], audioProcessor.Setting[e_Low], 100, 700, 25, " Hz");
-    GUI_Init_Large_Slider(&sldKnob[e_High], audioProcessor.Setting[e_High], 700, 1800, 50, " Hz");
-    GUI_Init_Large_Slider(&sldKnob[e_Drive], audioProcessor.Setting[e_Drive], 0.0f, 1.0f, .01f, "");
-    GUI_Init_Large_Slider(&sldKnob[e_EnhLow], audioProcessor.Setting[e_EnhLow], 0.0f, 1.0f, .01f, "");
-    GUI_Init_Large_Slider(&sldKnob[e_EnhHigh], audioProcessor.Setting[e_EnhHigh], 0.0f, 1.0f, .01f, "");
-    GUI_Init_Large_Slider(&sldKnob[e_Mix], audioProcessor.Setting[e_Mix], 0.0f, 1.0f, .01f, "");
+    GUI_Init_Large_Slider(&sldKnob[e_Gain], audioProcessor.Parm_Get(e_Gain), 0.0f, 2.0f, .01f, ""); 
+    GUI_Init_Large_Slider(&sldKnob[e_NGate], audioProcessor.Parm_Get(e_NGate), 0.0f, 1.0f, .01f, "");
+    GUI_Init_Large_Slider(&sldKnob[e_Low], audioProcessor.Parm_Get(e_Low), 100, 700, 25, " Hz");
+    GUI_Init_Large_Slider(&sldKnob[e_High], audioProcessor.Parm_Get(e_High), 700, 1800, 50, " Hz");
+    GUI_Init_Large_Slider(&sldKnob[e_Drive], audioProcessor.Parm_Get(e_Drive), 0.0f, 1.0f, .01f, "");
+    GUI_Init_Large_Slider(&sldKnob[e_EnhLow], audioProcessor.Parm_Get(e_EnhLow), 0.0f, 1.0f, .01f, "");
+    GUI_Init_Large_Slider(&sldKnob[e_EnhHigh], audioProcessor.Parm_Get(e_EnhHigh), 0.0f, 1.0f, .01f, "");
+    GUI_Init_Large_Slider(&sldKnob[e_Mix], audioProcessor.Parm_Get(e_Mix), 0.0f, 1.0f, .01f, "");
 
     //R1.00 Define the knob (slider) positions on the screen/UI.
     KNOB_DefinePosition(e_Gain,   10, 60, 90, 90, "Gain");
@@ -65,7 +65,10 @@ MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcess
     imgBackground = juce::ImageCache::getFromMemory(BinaryData::makoodback01_jpg, BinaryData::makoodback01_jpgSize);
 
     //R2.00 Start our Timer so we can tell the user they are clipping. Could draw VU Meters here, etc.
-    startTimerHz(2);  //R1.00 have our Timer get called twice per second.
+    //R1.01 The timer now drives the meters too, so it runs at Meter_Hz. The processor only
+    //R1.01 sends meter frames while Meter_Active is set.
+    audioProcessor.Meter_Active = true;
+    startTimerHz(Meter_Hz);
 
     //R1.00 Create a label to let user know they are clipping.
     //R1.00 Color vars are AARRGGBB. Alpha, Red, Green, Blue. Alpha 00 = see thru.
@@ -74,37 +77,153 @@ MakoBiteAudioProcessorEditor::MakoBiteAudioProcessorEditor (MakoBiteAudioProcess
     labClipping.setColour(juce::Label::textColourId, juce::Colour(0xFF000000));       //R1.00 BLACK for OFF state.
     labClipping.setColour(juce::Label::outlineColourId, juce::Colour(0x00000000));    //R1.00 We dont want to see this so make it see thru.
     labClipping.setText("CLIPPING", juce::dontSendNotification);
-    addAndMakeVisible(labClipping);
+    Content.addAndMakeVisible(labClipping);
+
+    //R1.01 Opens the spectrum analyzer panel under the knobs.
+    btnAnalyzer.setButtonText("SPECTRUM");
+    btnAnalyzer.setClickingTogglesState(true);
+    btnAnalyzer.setToggleState(audioProcessor.Analyzer_Open, juce::dontSendNotification);
+    btnAnalyzer.onClick = [this] { Analyzer_Show(btnAnalyzer.getToggleState()); };
+    Content.addAndMakeVisible(btnAnalyzer);
+
+#if MAKO_PROFILE
+    labProfile.setJustificationType(juce::Justification::centredLeft);
+    labProfile.setFont(juce::Font(10.0f));
+    labProfile.setColour(juce::Label::backgroundColourId, juce::Colour(0xFF000000));
+    labProfile.setColour(juce::Label::textColourId, juce::Colour(0xFFA0A0A0));
+    Content.addAndMakeVisible(labProfile);
+#endif
 
     //R1.00 Help Text! Must be LAST defined object to be blank at the start.
     labHelp.setJustificationType(juce::Justification::centred);
     labHelp.setColour(juce::Label::backgroundColourId, juce::Colour(0xFF000000));
     labHelp.setColour(juce::Label::textColourId, juce::Colour(0xFFA0A0A0));
     labHelp.setColour(juce::Label::outlineColourId, juce::Colour(0xFF404040));
-    addAndMakeVisible(labHelp);
+    Content.addAndMakeVisible(labHelp);
     labHelp.setText("Mako OverDrive v1.0", juce::dontSendNotification);
 
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
+    //R1.01 All controls live in Content at the original 450x250 layout. Content is scaled to fit the window.
+    //R1.01 Mouse clicks go thru Content to the controls.
+    Content.setInterceptsMouseClicks(false, true);
+    addAndMakeVisible(Content);
+
+    //R1.01 Resizable, keeping the shape of the background. Our paint covers every pixel, so we are opaque.
+    setOpaque(true);
+    setResizable(true, true);
+
     //R1.00 Set the window size LAST. Resize starts immediately.
     //R1.00 Last or none of your stuff will draw because it isnt defined yet.
-    setSize(450, 250);
+    //R1.01 Open at the size the user last left it, with the analyzer if it was open. Analyzer_Show sets the size.
+    Editor_Scale = audioProcessor.Editor_Scale;
+    Analyzer_Show(audioProcessor.Analyzer_Open);
 }
 
 MakoBiteAudioProcessorEditor::~MakoBiteAudioProcessorEditor()
 {
+    audioProcessor.Meter_Active = false;
+    audioProcessor.Analyzer_Active = false;
+    Analyzer.reset();
+}
+
+void MakoBiteAudioProcessorEditor::Analyzer_Show(bool Open)
+{
+    //R1.01 The thread and the audio taps only run while the panel is open.
+    audioProcessor.Analyzer_Open = Open;
+    if (Open && (Analyzer == nullptr))
+    {
+        Analyzer = std::make_unique<MakoAnalyzer>(audioProcessor.Analyzer_Pre, audioProcessor.Analyzer_Post, audioProcessor.Analyzer_Coeffs);
+        Analyzer->SetRate(audioProcessor.Analyzer_Rate());
+        Analyzer->startThread();
+        audioProcessor.Analyzer_Active = true;
+    }
+    else if (!Open && (Analyzer != nullptr))
+    {
+        audioProcessor.Analyzer_Active = false;
+        Analyzer.reset();
+        Analyzer_HasView = false;
+    }
+
+    //R1.01 Same scale, taller window. The aspect ratio changes with the panel.
+    Editor_Height = Editor_BaseHeight + (Open ? Analyzer_Height : 0);
+    getConstrainer()->setFixedAspectRatio(double(Editor_Width) / double(Editor_Height));
+    setResizeLimits(Editor_Width / 2, Editor_Height / 2, Editor_Width * 4, Editor_Height * 4);
+    setSize(juce::roundToInt(Editor_Width * Editor_Scale), juce::roundToInt(Editor_Height * Editor_Scale));
 }
 
 void MakoBiteAudioProcessorEditor::timerCallback()
 {
+    //R1.01 Collect every block the processor sent since the last tick.
+    tp_meter_frame Frame;
+    float InPeak = 0.0f, OutPeak = 0.0f, InSum = 0.0f, OutSum = 0.0f, Gate = 1.0f;
+    int Clips = 0, Samples = 0;
+    while (audioProcessor.Meter.Pop(Frame))
+    {
+        InPeak = juce::jmax(InPeak, Frame.InPeak);
+        OutPeak = juce::jmax(OutPeak, Frame.OutPeak);
+        InSum += Frame.InRms * Frame.InRms * float(Frame.Samples);
+        OutSum += Frame.OutRms * Frame.OutRms * float(Frame.Samples);
+        Gate = juce::jmin(Gate, Frame.GateGain);
+        Clips += Frame.Clips;
+        Samples += Frame.Samples;
+    }
+
+    //R1.01 Meter ballistics. No new blocks (transport stopped) lets the meters fall.
+    const float Fall = std::exp(-1.0f / (.3f * float(Meter_Hz)));
+    const float FallPeak = std::exp(-1.0f / (1.0f * float(Meter_Hz)));
+    float InRms = (0 < Samples) ? std::sqrt(InSum / float(Samples)) : 0.0f;
+    float OutRms = (0 < Samples) ? std::sqrt(OutSum / float(Samples)) : 0.0f;
+    Meter_In = juce::jmax(Meter_Scale(InRms), Meter_In * Fall);
+    Meter_Out = juce::jmax(Meter_Scale(OutRms), Meter_Out * Fall);
+    Meter_InPeak = juce::jmax(Meter_Scale(InPeak), Meter_InPeak * FallPeak);
+    Meter_OutPeak = juce::jmax(Meter_Scale(OutPeak), Meter_OutPeak * FallPeak);
+    if (0 < Samples) Meter_Gate = Gate;
+
+    //R1.01 Only repaint the meter area, and only when a bar moved a pixel.
+    const int W = Meter_Area.getWidth();
+    int Drawn[5] = { int(Meter_In * W), int(Meter_Out * W), int(Meter_InPeak * W), int(Meter_OutPeak * W), int(Meter_Gate * W) };
+    bool Changed = false;
+    for (int t = 0; t < 5; t++)
+    {
+        if (Drawn[t] != Meter_Drawn[t]) Changed = true;
+        Meter_Drawn[t] = Drawn[t];
+    }
+    if (Changed) repaint(juce::Rectangle<float>(Meter_Area.getX() * Editor_Scale, Meter_Area.getY() * Editor_Scale,
+                                                Meter_Area.getWidth() * Editor_Scale, Meter_Area.getHeight() * Editor_Scale).getSmallestIntegerContainer());
+
+    //R1.01 Pick up the latest spectrum from the analyzer thread.
+    if (Analyzer != nullptr)
+    {
+        Analyzer->SetRate(audioProcessor.Analyzer_Rate());
+        if (Analyzer->View.Fetch())
+        {
+            Analyzer_View = Analyzer->View.Front();
+            Analyzer_HasView = true;
+            repaint(juce::Rectangle<float>(Analyzer_Area.getX() * Editor_Scale, Analyzer_Area.getY() * Editor_Scale,
+                                           Analyzer_Area.getWidth() * Editor_Scale, Analyzer_Area.getHeight() * Editor_Scale).getSmallestIntegerContainer());
+        }
+    }
+
+#if MAKO_PROFILE
+    if (Meter_Hz <= ++Profile_Tick)
+    {
+        Profile_Tick = 0;
+        labProfile.setText(audioProcessor.Profile.Summary(), juce::dontSendNotification);
+    }
+#endif
+
     //R1.00 Check processor if audio is clipping.
-    //R1.00 Track the Label stats so we are not redrawing the control twice a second.
-    if (audioProcessor.AudioIsClipping)
+    //R1.00 Track the Label stats so we are not redrawing the control every tick.
+    //R1.01 Hold the warning for half a second so short clips are still seen.
+    if (0 < Clips) Clip_Hold = Meter_Hz / 2;
+    if (0 < Clip_Hold)
     {
-        audioProcessor.AudioIsClipping = false;
+        Clip_Hold--;
+        if (!STATE_Clip)
+            labClipping.setColour(juce::Label::textColourId, juce::Colour(0xFFFFFF00));
         STATE_Clip = true;
-        labClipping.setColour(juce::Label::textColourId, juce::Colour(0xFFFFFF00));
     }
     else
     {
@@ -114,12 +233,141 @@ void MakoBiteAudioProcessorEditor::timerCallback()
     }
 }
 
+float MakoBiteAudioProcessorEditor::Meter_Scale(float Level) const
+{
+    //R1.01 -60 dB to 0 dB maps to 0-1.
+    float dB = juce::Decibels::gainToDecibels(Level, -60.0f);
+    return juce::jlimit(0.0f, 1.0f, (dB + 60.0f) / 60.0f);
+}
+
+void MakoBiteAudioProcessorEditor::Meter_Draw(juce::Graphics& g)
+{
+    //R1.01 Three bars: IN, OUT and GATE. Levels are green, turning yellow in the top 6 dB.
+    const int x = Meter_Area.getX();
+    const int w = Meter_Area.getWidth();
+    const float Bar[3] = { Meter_In, Meter_Out, Meter_Gate };
+    const float Peak[3] = { Meter_InPeak, Meter_OutPeak, -1.0f };
+    const juce::String Name[3] = { "IN", "OUT", "GATE" };
+
+    g.setFont(10.0f);
+    for (int t = 0; t < 3; t++)
+    {
+        int y = Meter_Area.getY() + t * 19;
+        g.setColour(juce::Colour(0xFFA0A0A0));
+        g.drawText(Name[t], x, y, w, 8, juce::Justification::centredLeft, false);
+
+        g.setColour(juce::Colour(0xFF000000));
+        g.fillRect(x, y + 9, w, 8);
+        int len = int(Bar[t] * w);
+        if (t == 2)
+            g.setColour(juce::Colour(0xFF0A6496));
+        else
+            g.setColour((.9f < Bar[t]) ? juce::Colour(0xFFFFFF00) : juce::Colour(0xFF20C020));
+        g.fillRect(x, y + 10, len, 6);
+        if (0.0f <= Peak[t])
+        {
+            g.setColour(juce::Colour(0xFFFFFFFF));
+            g.fillRect(x + juce::jmin(w - 1, int(Peak[t] * w)), y + 9, 1, 8);
+        }
+    }
+}
+
 //==============================================================================
 void MakoBiteAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     //g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-    
+
+    //R1.01 The background is drawn into Bg_Cache at the real screen pixel size (window size x display scale)
+    //R1.01 the first time, and again only after a resize or a move to a screen with another scale.
+    //R1.01 Every other paint is a 1:1 copy of the part that changed.
+    const float Pixels = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const int W = juce::jmax(1, juce::roundToInt(getWidth() * Pixels));
+    const int H = juce::jmax(1, juce::roundToInt(getHeight() * Pixels));
+    if ((Bg_Cache.getWidth() != W) || (Bg_Cache.getHeight() != H))
+    {
+        Bg_Cache = juce::Image(juce::Image::RGB, W, H, false);
+        juce::Graphics gb(Bg_Cache);
+        gb.setImageResamplingQuality(juce::Graphics::highResamplingQuality);
+        gb.addTransform(juce::AffineTransform::scale(float(W) / float(Editor_Width), float(H) / float(Editor_Height)));
+        Background_Render(gb);
+    }
+    g.drawImage(Bg_Cache, getLocalBounds().toFloat());
+
+    //R1.01 Meters change all the time so they are not cached. Drawn in the 450x250 layout.
+    g.addTransform(juce::AffineTransform::scale(Editor_Scale));
+    Meter_Draw(g);
+    if (Analyzer_HasView) Analyzer_Draw(g);
+}
+
+float MakoBiteAudioProcessorEditor::Analyzer_X(int Point) const
+{
+    //R1.01 The analyzer points are log spaced over the whole width.
+    return float(Analyzer_Area.getX()) + float(Analyzer_Area.getWidth()) * float(Point) / float(MAKO_ANALYZER_POINTS - 1);
+}
+
+void MakoBiteAudioProcessorEditor::Analyzer_DrawGrid(juce::Graphics& g)
+{
+    //R1.01 Panel, frequency lines and dB scales. Part of the cached background.
+    const juce::Rectangle<int> a = Analyzer_Area;
+    g.setColour(juce::Colour(0xFF202020));
+    g.fillRect(0, Editor_BaseHeight, Editor_Width, Analyzer_Height);
+    g.setColour(juce::Colour(0xFF000000));
+    g.fillRect(a);
+
+    const float Decade = std::log10(MAKO_ANALYZER_HIHZ / MAKO_ANALYZER_LOHZ);
+    const float Hz[9] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+    const juce::String Name[9] = { "50", "100", "200", "500", "1k", "2k", "5k", "10k", "20k" };
+    g.setFont(9.0f);
+    for (int t = 0; t < 9; t++)
+    {
+        int x = a.getX() + juce::roundToInt(float(a.getWidth()) * std::log10(Hz[t] / MAKO_ANALYZER_LOHZ) / Decade);
+        g.setColour(juce::Colour(0xFF303030));
+        g.fillRect(x, a.getY(), 1, a.getHeight());
+        g.setColour(juce::Colour(0xFFA0A0A0));
+        g.drawText(Name[t], x - 15, a.getBottom() + 1, 30, 10, juce::Justification::centred, false);
+    }
+
+    //R1.01 Spectrum dBFS on the left, voicing gain on the right. Every 24 dB is every 20 dB of gain.
+    for (int t = 0; t <= 4; t++)
+    {
+        int y = a.getY() + juce::roundToInt(float(a.getHeight()) * float(t) / 4.0f);
+        g.setColour(juce::Colour(0xFF303030));
+        g.fillRect(a.getX(), y, a.getWidth(), 1);
+        g.setColour(juce::Colour(0xFFA0A0A0));
+        g.drawText(juce::String(-24 * t), 0, y - 5, a.getX() - 3, 10, juce::Justification::centredRight, false);
+        g.setColour(juce::Colour(0xFF5085E8));
+        g.drawText(juce::String(48 - 15 * t), a.getRight() + 3, y - 5, Editor_Width - a.getRight() - 3, 10, juce::Justification::centredLeft, false);
+    }
+}
+
+void MakoBiteAudioProcessorEditor::Analyzer_Draw(juce::Graphics& g)
+{
+    //R1.01 Input spectrum in grey, output in red, voicing in blue.
+    const juce::Rectangle<int> a = Analyzer_Area;
+    const float Top = float(a.getY());
+    const float H = float(a.getHeight());
+    auto Curve = [&](const float* dB, float dBTop, float dBRange, juce::Colour Col)
+    {
+        juce::Path p;
+        for (int t = 0; t < MAKO_ANALYZER_POINTS; t++)
+        {
+            float y = Top + H * juce::jlimit(0.0f, 1.0f, (dBTop - dB[t]) / dBRange);
+            if (t == 0) p.startNewSubPath(Analyzer_X(t), y);
+            else p.lineTo(Analyzer_X(t), y);
+        }
+        g.setColour(Col);
+        g.strokePath(p, juce::PathStrokeType(1.0f));
+    };
+
+    Curve(Analyzer_View.Pre, 0.0f, 96.0f, juce::Colour(0xFF707070));
+    Curve(Analyzer_View.Post, 0.0f, 96.0f, juce::Colour(0xFFFF4040));
+    if (Analyzer_View.HasResponse) Curve(Analyzer_View.Response, 48.0f, 60.0f, juce::Colour(0xFF5085E8));
+}
+
+void MakoBiteAudioProcessorEditor::Background_Render(juce::Graphics& g)
+{
+    //R1.01 The original background drawing, in the 450x250 layout. Only used to fill Bg_Cache.
     bool UseBackgroundImage = true;
     if (UseBackgroundImage)
     {
@@ -145,6 +393,9 @@ void MakoBiteAudioProcessorEditor::paint (juce::Graphics& g)
         g.setColour(juce::Colours::white);
         for (int t = 0; t < Knob_Cnt; t++) g.drawFittedText(Knob_Name[t], Knob_Pos[t].x, Knob_Pos[t].y - 15, Knob_Pos[t].sizex, 15, juce::Justification::centred, 1);
     }
+
+    //R1.01 The analyzer panel below the original layout.
+    if (Editor_BaseHeight < Editor_Height) Analyzer_DrawGrid(g);
 }
 
 void MakoBiteAudioProcessorEditor::resized()
@@ -152,11 +403,23 @@ void MakoBiteAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 
+    //R1.01 Scale the 450x250 layout to the window. The aspect ratio is fixed, so one scale fits both ways.
+    //R1.01 Content grows by Analyzer_Height when the analyzer is open.
+    Editor_Scale = float(getWidth()) / float(Editor_Width);
+    audioProcessor.Editor_Scale = Editor_Scale;
+    Content.setBounds(0, 0, Editor_Width, Editor_Height);
+    Content.setTransform(juce::AffineTransform::scale(Editor_Scale));
+
     //R1.00 Draw all of the defined KNOBS.
+    //R1.01 Positions are in the 450x250 layout, inside Content.
     for (int t = 0; t < Knob_Cnt; t++) sldKnob[t].setBounds(Knob_Pos[t].x, Knob_Pos[t].y, Knob_Pos[t].sizex, Knob_Pos[t].sizey);
 
     labClipping.setBounds(360, 15, 70, 18);
+    btnAnalyzer.setBounds(360, 37, 70, 16);
     labHelp.setBounds(5, 220, 440, 18);
+#if MAKO_PROFILE
+    labProfile.setBounds(5, 238, 440, 12);
+#endif
 }
 
 void MakoBiteAudioProcessorEditor::GUI_Init_Large_Slider(juce::Slider* slider, float Val, float Vmin, float Vmax, float Vinterval, juce::String Suffix)
@@ -167,7 +430,7 @@ void MakoBiteAudioProcessorEditor::GUI_Init_Large_Slider(juce::Slider* slider, f
     slider->setRange(Vmin, Vmax, Vinterval);
     slider->setValue(Val);
     slider->addListener(this);
-    addAndMakeVisible(slider);
+    Content.addAndMakeVisible(slider);
 
     //R1.00 Override the default Juce drawing routines and use ours.
     //R1.00 This is how we have custom SLIDER controls.
@@ -217,11 +480,7 @@ void MakoBiteAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
             //R1.00 Update HELP bar with help for the SLIDER being adjusted.
             labHelp.setText(HelpString[t], juce::dontSendNotification);
 
-            //R1.00 Update the actual processor variable being edited.
-            audioProcessor.Setting[t] = float(sldKnob[t].getValue());
-
-            //R1.00 Increment changed var to be sure, every change gets made, changed var is decremented in processor.
-            audioProcessor.SettingsChanged += 1;
+            //R1.01 The slider attachment updates the parameter. The processor picks it up on its next block.
 
             //R1.00 We have captured the correct slider change, exit this function.
             return;
@@ -80,7 +80,74 @@ public:
     }
 
     //R1.00 Override the Juce SLIDER drawing function so our code gets called instead of Juces code.
+    //R1.01 The knob face comes from a pre drawn image (see tp_knob_cache). Only the pointer is drawn live.
     void drawRotarySlider(juce::Graphics& g, int x, int y, int width, int height, float sliderPos, const float rotaryStartAngle, const float rotaryEndAngle, juce::Slider& sld) override
+    {
+        //R1.01 Scale is rounded up to a quarter step so dragging the editor size does not draw a new face every pixel.
+        const float Scale = std::ceil(g.getInternalContext().getPhysicalPixelScaleFactor() * 4.0f) / 4.0f;
+        const tp_knob_cache& kc = Knob_GetCache(width, height, Scale);
+        g.drawImage(kc.Face, juce::Rectangle<float>((float)x + kc.OffsetX, (float)y + kc.OffsetY, kc.Size, kc.Size));
+
+        //R1.00 Dont draw anymore objects if the control is disabled.
+        if (sld.isEnabled() == false) return;
+
+        Knob_Render(g, x, y, width, height, rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle), false, true);
+    }
+
+private:
+    //R1.01 The knob face and bevel for one knob size and display scale. Size x Size (times the display scale),
+    //R1.01 placed at Offset inside the slider's knob area.
+    struct tp_knob_cache {
+        int Width = 0;
+        int Height = 0;
+        float Scale = 0.0f;
+        float Size = 0.0f;
+        float OffsetX = 0.0f;
+        float OffsetY = 0.0f;
+        juce::Image Face;
+    };
+
+    //R1.01 Shared by every editor. Only used on the message thread.
+    static std::vector<tp_knob_cache>& Knob_Cache()
+    {
+        static std::vector<tp_knob_cache> Cache;
+        return Cache;
+    }
+
+    const tp_knob_cache& Knob_GetCache(int width, int height, float Scale)
+    {
+        std::vector<tp_knob_cache>& KnobCache = Knob_Cache();
+        for (const tp_knob_cache& kc : KnobCache)
+            if ((kc.Width == width) && (kc.Height == height) && (kc.Scale == Scale))
+                return kc;
+
+        //R1.01 New size or scale (editor resized or moved to another screen). Only a few are ever used, so old ones are dropped.
+        if (8 <= KnobCache.size()) KnobCache.clear();
+
+        tp_knob_cache kc;
+        kc.Width = width;
+        kc.Height = height;
+        kc.Scale = Scale;
+
+        //R1.01 A square around the knob with room for the bevel and pointer line.
+        float radius = (float)juce::jmin(width / 2, height / 2) - 6.0f;
+        kc.Size = std::ceil(radius * 2.0f) + 8.0f;
+        kc.OffsetX = (float)width * 0.5f - kc.Size * 0.5f;
+        kc.OffsetY = (float)height * 0.5f - kc.Size * 0.5f;
+        int Pixels = juce::jmax(1, (int)std::ceil(kc.Size * Scale));
+        auto ToImage = juce::AffineTransform::translation(-kc.OffsetX, -kc.OffsetY).scaled((float)Pixels / kc.Size);
+
+        kc.Face = juce::Image(juce::Image::ARGB, Pixels, Pixels, true, juce::SoftwareImageType());
+        juce::Graphics gi(kc.Face);
+        gi.addTransform(ToImage);
+        Knob_Render(gi, 0, 0, width, height, 0.0f, true, false);
+
+        KnobCache.push_back(kc);
+        return KnobCache.back();
+    }
+
+    //R1.01 The original knob drawing. Draws the face (into the cache), the pointer (live) or both.
+    void Knob_Render(juce::Graphics& g, int x, int y, int width, int height, float angle, bool DrawFace, bool DrawPointer)
     {
         //R1.00 Most of these are from JUCE demo code. Could be reduced if not used.
         //R1.00 Radius changed to -6.0f to reduce the final slider size.
@@ -90,43 +157,41 @@ public:
         auto rx = centreX - radius;
         auto ry = centreY - radius;
         auto rw = radius * 2.0f;
-        auto angle = rotaryStartAngle + sliderPos * (rotaryEndAngle - rotaryStartAngle);
 
         //R1.00 Our Var defs.
         float sinA;
         float cosA;
         juce::ColourGradient ColGrad;
-        int col;
-              
-        //1.00 Draw the KNOB face.
-        ColGrad = juce::ColourGradient(juce::Colour(0xFF606060), 0.0f, y, juce::Colour(0xFF101010), 0.0f, y + height, false);
-        g.setGradientFill(ColGrad);
-        g.fillEllipse(rx, ry, rw, rw);       
-
-        //R1.00 Draw shading around knob face.
-        //g.setColour(juce::Colours::black);
-        //g.drawEllipse(rx - 2.0f, ry - 2.0f, rw + 4.0f, rw + 4.0f, 1.0f);
-        ColGrad = juce::ColourGradient(juce::Colour(0xFFFFFFFF), 0.0f, y, juce::Colour(0xFF606060), 0.0f, y + height, false);
-        g.setGradientFill(ColGrad);
-        g.drawEllipse(rx, ry, rw, rw, 2.0f);        
 
-        //R1.00 Dont draw anymore objects if the control is disabled.
-        if (sld.isEnabled() == false) return;
+        if (DrawFace)
+        {
+            //1.00 Draw the KNOB face.
+            ColGrad = juce::ColourGradient(juce::Colour(0xFF606060), 0.0f, y, juce::Colour(0xFF101010), 0.0f, y + height, false);
+            g.setGradientFill(ColGrad);
+            g.fillEllipse(rx, ry, rw, rw);
+
+            //R1.00 Draw shading around knob face.
+            ColGrad = juce::ColourGradient(juce::Colour(0xFFFFFFFF), 0.0f, y, juce::Colour(0xFF606060), 0.0f, y + height, false);
+            g.setGradientFill(ColGrad);
+            g.drawEllipse(rx, ry, rw, rw, 2.0f);
+        }
 
-        //R1.00 Copy our predefined KNOB PATH, scale it, and then transform it to the centre position.
-        //R1.00 The knob SIZE must be performed first. It is then ROTATED around its center. Then moved (TRANSLATED) to the screen knob position.
-        juce::Path pK = pathKnob;
-        pK.applyTransform(juce::AffineTransform::scale(radius / 11.0f).followedBy(juce::AffineTransform::rotation(angle).translated(centreX, centreY)));
-        ColGrad = juce::ColourGradient(juce::Colour(0xFFC0C0C0), 0.0f, y, juce::Colour(0xFF000000), 0.0f, y + height, false);
-        g.setGradientFill(ColGrad);
-        g.strokePath(pK, juce::PathStrokeType(2.0f));
-                
-        //R1.00 Draw finger adjust indicator.
-        sinA = std::sinf(angle) * radius;
-        cosA = std::cosf(angle) * radius;
-        g.setColour(juce::Colours::whitesmoke);
-        g.drawLine(centreX + sinA * .75f, centreY - cosA * .75f, centreX + sinA, centreY - cosA, 4.0f);
-                
+        if (DrawPointer)
+        {
+            //R1.00 Copy our predefined KNOB PATH, scale it, and then transform it to the centre position.
+            //R1.00 The knob SIZE must be performed first. It is then ROTATED around its center. Then moved (TRANSLATED) to the screen knob position.
+            juce::Path pK = pathKnob;
+            pK.applyTransform(juce::AffineTransform::scale(radius / 11.0f).followedBy(juce::AffineTransform::rotation(angle).translated(centreX, centreY)));
+            ColGrad = juce::ColourGradient(juce::Colour(0xFFC0C0C0), 0.0f, y, juce::Colour(0xFF000000), 0.0f, y + height, false);
+            g.setGradientFill(ColGrad);
+            g.strokePath(pK, juce::PathStrokeType(2.0f));
+
+            //R1.00 Draw finger adjust indicator.
+            sinA = std::sinf(angle) * radius;
+            cosA = std::cosf(angle) * radius;
+            g.setColour(juce::Colours::whitesmoke);
+            g.drawLine(centreX + sinA * .75f, centreY - cosA * .75f, centreX + sinA, centreY - cosA, 4.0f);
+        }
     }
 };
 
@@ -148,6 +213,18 @@ public:
     //R1.00 The images are added in PROJUCER and embedded into our C++ Project.
     juce::Image imgBackground;
 
+    //R1.01 The editor is resizable. Everything is laid out at Editor_Width x Editor_Height inside Content,
+    //R1.01 which is scaled by Editor_Scale. The background is drawn once into Bg_Cache per pixel size (see paint).
+    //R1.01 The analyzer panel adds Analyzer_Height below the original 450x250 layout.
+    const int Editor_Width = 450;
+    const int Editor_BaseHeight = 250;
+    const int Analyzer_Height = 120;
+    int Editor_Height = 250;
+    float Editor_Scale = 1.0f;
+    juce::Component Content;
+    juce::Image Bg_Cache;
+    void Background_Render(juce::Graphics& g);
+
     //==============================================================================
     void paint (juce::Graphics&) override;
     void resized() override;
@@ -194,6 +271,37 @@ private:
     //R1.00 Label to show user we are clipping (Too loud). 
     juce::Label labClipping;
     bool STATE_Clip = false;
+    int Clip_Hold = 0;                  //R1.01 Timer ticks left to show CLIPPING after the last clipped block.
+
+    //R1.01 Meters, fed from the processor meter frames by our timer. Bar lengths are 0-1.
+    const int Meter_Hz = 60;
+    float Meter_In = 0.0f;              //R1.01 RMS bars. Rise instantly, fall over about .3 s.
+    float Meter_Out = 0.0f;
+    float Meter_InPeak = 0.0f;          //R1.01 Peak ticks, fall a little slower.
+    float Meter_OutPeak = 0.0f;
+    float Meter_Gate = 1.0f;            //R1.01 Noise gate gain. 1 = open.
+    int Meter_Drawn[5] = {};            //R1.01 Pixel lengths last painted, so we only repaint on a change.
+    juce::Rectangle<int> Meter_Area { 355, 158, 85, 56 };
+    float Meter_Scale(float Level) const;
+    void Meter_Draw(juce::Graphics& g);
+
+    //R1.01 Spectrum analyzer panel. The analyzer thread only runs while the panel is open.
+    //R1.01 Spectra use dBFS (0 at the top, -96 at the bottom), the voicing curve +48 to -12 dB.
+    juce::TextButton btnAnalyzer;
+    std::unique_ptr<MakoAnalyzer> Analyzer;
+    tp_analyzer_view Analyzer_View;
+    bool Analyzer_HasView = false;
+    juce::Rectangle<int> Analyzer_Area { 30, 256, 390, 98 };
+    void Analyzer_Show(bool Open);
+    float Analyzer_X(int Point) const;
+    void Analyzer_DrawGrid(juce::Graphics& g);
+    void Analyzer_Draw(juce::Graphics& g);
+
+#if MAKO_PROFILE
+    //R1.01 Profile builds only. Average microseconds per block for each stage, updated once a second.
+    juce::Label labProfile;
+    int Profile_Tick = 0;
+#endif
 
 
 public:
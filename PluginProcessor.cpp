@@ -32,17 +32,42 @@ MakoBiteAudioProcessor::MakoBiteAudioProcessor()
       std::make_unique<juce::AudioParameterFloat>("enhlow","Enhlow", .0f, 1.0f, .0f),
       std::make_unique<juce::AudioParameterFloat>("enhhigh","Enhhigh", .0f, 1.0f, .0f),
       std::make_unique<juce::AudioParameterFloat>("mix","Mix", .0f, 1.0f, 1.0f),
+      std::make_unique<juce::AudioParameterChoice>("quality","Quality", juce::StringArray { "1x", "2x", "4x", "8x" }, 0),
+      std::make_unique<juce::AudioParameterChoice>("shaper","Shaper", juce::StringArray { "Tanh", "ADAA 1", "ADAA 2" }, 0),
     }
 
     )
 
 #endif
 {
-   
+    //R1.01 Keep a pointer to each parameter so the audio thread can read them without a string lookup.
+    //R1.01 Order MUST match the e_ values.
+    const char* ParmIDs[] = { "gain", "ngate", "low", "high", "drive", "enhlow", "enhhigh", "mix", "quality", "shaper" };
+    for (int t = 0; t < e_ParmCount; t++)
+    {
+        Parm_Value[t] = parameters.getRawParameterValue(ParmIDs[t]);
+        Parm_Object[t] = parameters.getParameter(ParmIDs[t]);
+    }
+
+    //R1.01 Factory presets, plus the user bank if there is one. A bad user bank just leaves the factory ones.
+    juce::String error;
+    if (! Preset_LoadBank(Preset_UserBankFile(), error))
+    {
+        auto bank = std::make_unique<MakoPresetBank>(e_PresetParms);
+        Preset_Factory(*bank);
+        Preset_Bank = bank.get();
+        Preset_Banks.push_back(std::move(bank));
+    }
+
+    //R1.01 Copies MIDI program changes into the parameters so the host and editor see them.
+    //R1.01 Timers belong to the message thread. The tools also build processors on worker threads.
+    if (juce::MessageManager::existsAndIsCurrentThread()) startTimerHz(20);
 }
 
 MakoBiteAudioProcessor::~MakoBiteAudioProcessor()
 {
+    //R1.01 First, so timerCallback can not run while the members it uses are going away.
+    stopTimer();
 }
 
 //==============================================================================
@@ -80,31 +105,167 @@ bool MakoBiteAudioProcessor::isMidiEffect() const
 
 double MakoBiteAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    //R1.01 Filter ring time plus the oversampling delay. Hosts use this to know when they can stop calling us.
+    return Tail_Seconds + double(getLatencySamples()) / double(HostRate);
 }
 
 int MakoBiteAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    return juce::jmax(1, Preset_Bank.load()->Count());   // NB: some hosts don't cope very well if you tell them there are 0 programs,
                 // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int MakoBiteAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return Program_Current;
 }
 
 void MakoBiteAudioProcessor::setCurrentProgram (int index)
 {
+    if ((index < 0) || (Preset_Bank.load()->Count() <= index)) return;
+
+    //R1.01 Some hosts (VST3 program parameter) call this from the audio thread. Then just flag it for processBlock.
+    if (juce::MessageManager::existsAndIsCurrentThread())
+    {
+        Program_Current = index;
+        Program_SetParms(index);
+    }
+    else
+        Program_Pending = index;
 }
 
 const juce::String MakoBiteAudioProcessor::getProgramName (int index)
 {
-    return {};
+    MakoPresetBank* bank = Preset_Bank.load();
+    return ((0 <= index) && (index < bank->Count())) ? bank->Name(index) : juce::String();
 }
 
 void MakoBiteAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    //R1.01 Only renames it for this session. Use Preset_SaveUserBank to keep presets.
+    MakoPresetBank* bank = Preset_Bank.load();
+    if ((0 <= index) && (index < bank->Count())) bank->SetName(index, newName);
+}
+
+void MakoBiteAudioProcessor::Preset_Factory(MakoPresetBank& bank)
+{
+    //R1.01 Gain, NGate, Low, High, Drive, EnhLow, EnhHigh, Mix. The first one is the parameter defaults.
+    struct tp_factory { const char* Name; float Value[8]; };
+    static const tp_factory Factory[] = {
+        { "Default",        { 1.0f, .0f, 350, 1250, .2f, .0f, .0f, 1.0f } },
+        { "Clean Boost",    { 1.6f, .0f, 200, 1800, .0f, .2f, .2f, .3f } },
+        { "Light Crunch",   { 1.0f, .1f, 400, 1400, .3f, .1f, .2f, .8f } },
+        { "Classic OD",     { 1.0f, .2f, 700, 900, .5f, .0f, .1f, 1.0f } },
+        { "Fat Lead",       { .9f, .3f, 300, 1100, .8f, .6f, .2f, 1.0f } },
+        { "Bright Edge",    { .9f, .2f, 500, 1800, .6f, .0f, .7f, .9f } },
+        { "Mid Push",       { 1.0f, .2f, 650, 750, .6f, .3f, .3f, 1.0f } },
+        { "Gated Heavy",    { .8f, .6f, 250, 1300, 1.0f, .5f, .5f, 1.0f } },
+    };
+    for (const tp_factory& f : Factory) bank.Add(f.Name, f.Value);
+}
+
+juce::File MakoBiteAudioProcessor::Preset_UserBankFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("MakoOD").getChildFile("UserPresets.mkob");
+}
+
+bool MakoBiteAudioProcessor::Preset_LoadBank(const juce::File& file, juce::String& error)
+{
+    //R1.01 Factory presets first, then the file. Presets missing a newer parameter get its default.
+    float Defaults[20] = {};
+    for (int t = 0; t < e_PresetParms; t++) Defaults[t] = Parm_Object[t]->convertFrom0to1(Parm_Object[t]->getDefaultValue());
+
+    auto bank = std::make_unique<MakoPresetBank>(e_PresetParms);
+    Preset_Factory(*bank);
+    if (! file.existsAsFile())
+    {
+        error = "No preset bank at " + file.getFullPathName();
+        return false;
+    }
+    MakoPresetBank user(e_PresetParms);
+    if (! user.ReadFile(file, Defaults, error)) return false;
+
+    //R1.01 The audio thread builds filters straight from these, so a damaged or hand edited file must not
+    //R1.01 get thru. Every value is snapped into its parameter's range and step. Non-finite ones get the default.
+    for (int p = 0; p < user.Count(); p++)
+    {
+        float Values[20] = {};
+        for (int t = 0; t < e_PresetParms; t++)
+        {
+            float v = user.Values(p)[t];
+            Values[t] = std::isfinite(v) ? Parm_Object[t]->convertFrom0to1(juce::jlimit(0.0f, 1.0f, Parm_Object[t]->convertTo0to1(v))) : Defaults[t];
+        }
+        bank->Add(user.Name(p), Values);
+    }
+
+    Preset_Bank = bank.get();
+    Preset_Banks.push_back(std::move(bank));
+    updateHostDisplay();
+    return true;
+}
+
+bool MakoBiteAudioProcessor::Preset_SaveUserBank(const juce::String& name, juce::String& error)
+{
+    //R1.01 Add the current sound to the user bank file and reload it, so it is a program right away.
+    const juce::File file = Preset_UserBankFile();
+    float Defaults[20] = {};
+    float Values[20] = {};
+    for (int t = 0; t < e_PresetParms; t++)
+    {
+        Defaults[t] = Parm_Object[t]->convertFrom0to1(Parm_Object[t]->getDefaultValue());
+        Values[t] = Parm_Get(t);
+    }
+
+    MakoPresetBank user(e_PresetParms);
+    if (file.existsAsFile() && (! user.ReadFile(file, Defaults, error))) return false;
+    user.Add(name, Values);
+    file.getParentDirectory().createDirectory();
+    if (! user.WriteFile(file))
+    {
+        error = "Can not write " + file.getFullPathName();
+        return false;
+    }
+    return Preset_LoadBank(file, error);
+}
+
+void MakoBiteAudioProcessor::Program_SetParms(int idx)
+{
+    //R1.01 Message thread. Tell the host and the editor about every changed value.
+    const float* Values = Preset_Bank.load()->Values(idx);
+    for (int t = 0; t < e_PresetParms; t++)
+        Parm_Object[t]->setValueNotifyingHost(Parm_Object[t]->convertTo0to1(Values[t]));
+}
+
+void MakoBiteAudioProcessor::Program_Apply(int idx)
+{
+    //R1.01 Audio thread. Switch now, from the values already in memory: no parsing, no allocation, no locks.
+    //R1.01 Settings_Snapshot uses these until each parameter moves, so it never waits on the timer.
+    MakoPresetBank* bank = Preset_Bank.load();
+    if ((idx < 0) || (bank->Count() <= idx)) return;
+    const float* Values = bank->Values(idx);
+    for (int t = 0; t < e_PresetParms; t++)
+    {
+        Program_Value[t] = Values[t];
+        Program_Raw[t] = Parm_Value[t]->load(std::memory_order_relaxed);
+        Program_Hold[t] = true;
+    }
+    Program_Current = idx;
+    Program_Sync = idx;
+}
+
+void MakoBiteAudioProcessor::timerCallback()
+{
+    //R1.01 The oversampling changed on the audio thread. Hosts want to hear about latency here.
+    int Latency = Latency_Pending.load();
+    if (Latency != getLatencySamples()) setLatencySamples(Latency);
+
+    //R1.01 A program was switched on the audio thread. Make the parameters match, so the host and editor show it.
+    //R1.01 The audio already uses the new values (Program_Hold).
+    int Sync = Program_Sync.load();
+    if (Sync < 0) return;
+    Program_SetParms(Sync);
+    Program_Sync.compare_exchange_strong(Sync, -1);
+    updateHostDisplay();
 }
 
 //==============================================================================
@@ -112,20 +273,95 @@ void MakoBiteAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlo
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
+    MAKO_AUDIT_PREPARE("prepareToPlay");
 
     //R1.00 Get our Sample Rate for filter calculations.
-    //R1.00 192k max here. Probably should not do this.
-    SampleRate = MakoBiteAudioProcessor::getSampleRate();
-    if (SampleRate < 21000) SampleRate = 48000;
-    if (192000 < SampleRate) SampleRate = 48000;
+    //R1.01 Use the rate we are given, any rate. Hosts without a play config (our command line tools) never set getSampleRate().
+    HostRate = (0.0 < sampleRate) ? float(sampleRate) : 48000.0f;
+
+    //R1.01 Pick the path for this play session. Both histories are cleared below.
+    Engine_Reference = Engine_UseScalarReference;
+
+    //R1.01 Internal rate mode. Halve the rate (up to 8x) while we stay at or above the internal rate.
+    //R1.01 The 10% slack lets a 48000 setting pick 44100 for 88.2k, 176.4k and 352.8k sessions.
+    Rate_Factor = 1;
+    if ((0.0f < Engine_InternalRate) && (!Engine_Reference))
+        while ((Rate_Factor < (1 << MAKO_OS_MAXSTAGES)) && (Engine_InternalRate * .9f <= HostRate / float(Rate_Factor * 2)))
+            Rate_Factor *= 2;
+    SampleRate = HostRate / float(Rate_Factor);
 
     //R1.00 Define our ENHANCE filters. These do not change, so calc once here.
     //R1.00 Our other filters change, so they are done in Settings_Update.
-    Filter_BP_Coeffs(18.0f, 450, .707f, &makoF_OD_EnhLow);
-    Filter_BP_Coeffs(18.0f, 1350, .707f, &makoF_OD_EnhHigh);
+    Filter_BP_Coeffs(18.0f, 450, .707f, &Block_State.makoF_OD_EnhLow);
+    Filter_BP_Coeffs(18.0f, 1350, .707f, &Block_State.makoF_OD_EnhHigh);
+
+    //R1.01 Low/High coeff tables for this rate. Shared with other instances at the same rate.
+    Coeff_BuildTables();
 
     //R1.00 Calc our OD low+high filters.
+    Settings_Snapshot();
     Settings_Update(true);
+    Ramp_Start(true, samplesPerBlock);
+
+    //R1.01 Per channel state for any number of channels, rounded up to whole lane groups.
+    //R1.01 Starts from silence. A new play session (or a new file in the render tool) must not hear the last one.
+    Engine_Channels = juce::jmax(1, juce::jmax(getTotalNumInputChannels(), getTotalNumOutputChannels()));
+    Engine_Groups = (Engine_Channels + MAKO_LANES - 1) / MAKO_LANES;
+    int LaneCount = Engine_Groups * MAKO_LANES;
+    Engine_Hot.assign(size_t(Engine_Groups), tp_lane_state());
+    Filter_Hist.assign(size_t(MAKO_SLOTS * LaneCount), tp_filter_hist());
+    Mono_Synced = true;
+    Mono_Dual = false;
+    Shaper_EnhHigh.assign(size_t(LaneCount), tp_adaa_state());
+    Shaper_Drive.assign(size_t(LaneCount), tp_adaa_state());
+    Shaper_EnhLow.assign(size_t(LaneCount), tp_adaa_state());
+
+    //R1.01 Size the block engine buffer. Bigger host blocks get processed in pieces of this size.
+    //R1.01 Capped so the 8x oversampling buffers stay small enough to live in the CPU cache.
+    Engine_BlockMax = juce::jlimit(16, 512, samplesPerBlock);
+    Engine_Lanes.assign(size_t(Engine_BlockMax) * MAKO_LANES, 0.0f);
+
+    //R1.01 Internal rate converter and its queues. Rate_Out starts with Rate_Factor - 1 samples of
+    //R1.01 silence so it always has enough for the host. That is the extra latency of this mode.
+    if (1 < Rate_Factor)
+    {
+        Engine_Rate.Prepare(Engine_BlockMax, Engine_Groups);
+        Engine_Rate.SetFactor(Rate_Factor);
+        Rate_In.assign(size_t(Engine_Groups), std::vector<float>(size_t(Rate_Factor * (Engine_BlockMax + 1)) * MAKO_LANES, 0.0f));
+        Rate_Out.assign(size_t(Engine_Groups), std::vector<float>(size_t(Rate_Factor * (Engine_BlockMax + 1)) * MAKO_LANES, 0.0f));
+    }
+    else
+    {
+        Rate_In.clear();
+        Rate_Out.clear();
+    }
+    Rate_InCount = 0;
+    Rate_OutCount = Rate_Factor - 1;
+    //R1.01 Fixed until the next prepareToPlay. Latency_Calc adds it to the oversampling latency.
+    Rate_Latency = (1 < Rate_Factor) ? Engine_Rate.GetLatency() * Rate_Factor + Rate_Factor - 1 : 0;
+
+    //R1.01 Allocate oversampling for the worst case (8x) so changing Quality never allocates.
+    //R1.01 Same for the EnhHigh/EnhLow coeffs at each oversampled rate.
+    for (int s = 0; s <= MAKO_OS_MAXSTAGES; s++)
+    {
+        tp_filter f = {};
+        Filter_BP_Coeffs(18.0f, 1350, .707f, &f, SampleRate * float(1 << s));
+        OS_EnhHighBy[s] = { f.a0, f.a1, f.a2, f.b1, f.b2 };
+        Filter_BP_Coeffs(18.0f, 450, .707f, &f, SampleRate * float(1 << s));
+        OS_EnhLowBy[s] = { f.a0, f.a1, f.a2, f.b1, f.b2 };
+    }
+    Engine_OS.Prepare(Engine_BlockMax, Engine_Groups);
+    OS_SetFactor(OS_ChooseFactor());
+    setLatencySamples(Latency_Pending.load());
+
+    //R1.01 Everything was just cleared, so start out idle until real audio arrives.
+    Tail_Update();
+    Silence_Samples = 0;
+    Silence_Idle = true;
+
+#if MAKO_PROFILE
+    Profile.Reset();
+#endif
 }
 
 void MakoBiteAudioProcessor::releaseResources()
@@ -142,15 +378,17 @@ bool MakoBiteAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     return true;
   #else
     // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    //R1.01 Any channel count works (mono, stereo, quad, 5.1, multi mic stems...).
+    //R1.01 Every channel gets the same settings. The block engine runs them 4 at a time.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
+    //R1.01 Mono in, stereo out is fine too. The mono input feeds both sides (see Mono_Check).
    #if ! JucePlugin_IsSynth
+    if ((layouts.getMainInputChannelSet() == juce::AudioChannelSet::mono())
+        && (layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo()))
+        return true;
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
    #endif
@@ -163,15 +401,55 @@ bool MakoBiteAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 void MakoBiteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+    MAKO_PROF_BLOCK_SCOPE();
+    MAKO_AUDIT_SCOPE("processBlock");
+    //R1.01 Fires if Engine_UseScalarReference changed without a prepareToPlay. We keep the path prepareToPlay picked.
+    jassert(Engine_Reference == Engine_UseScalarReference);
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     //R1.00 Our defined variables.
     float tS;
 
-    //R1.00 Handle any settings changes made in the Editor. Should only be small changes, so do not force all. 
-    //R1.00 SettingsChanged will grow as more settings change. This is not a TRUE/FLASE situation.
-    if (0 < SettingsChanged) Settings_Update(false);
+    //R1.01 Program changes. From the host off the message thread, or MIDI (bank select CC0/CC32 + program change).
+    //R1.01 The whole block uses the new program, ramping from the old values like any other change.
+    int Pending = Program_Pending.exchange(-1);
+    if (0 <= Pending) Program_Apply(Pending);
+    //R1.01 Read the raw bytes. getMessage() would copy every event, and allocate for long ones (sysex).
+    for (const juce::MidiMessageMetadata meta : midiMessages)
+    {
+        const juce::uint8* data = meta.data;
+        const int Status = (0 < meta.numBytes) ? (data[0] & 0xf0) : 0;
+        if ((Status == 0xb0) && (3 <= meta.numBytes) && (data[1] == 0))
+            Program_MidiBank = ((data[2] & 127) << 7) | (Program_MidiBank & 127);
+        else if ((Status == 0xb0) && (3 <= meta.numBytes) && (data[1] == 32))
+            Program_MidiBank = (Program_MidiBank & ~127) | (data[2] & 127);
+        else if ((Status == 0xc0) && (2 <= meta.numBytes))
+            Program_Apply(Program_MidiBank * 128 + (data[1] & 127));
+    }
+
+    //R1.01 Copy the parameters once for this block. Changes come from the host (automation) or the editor.
+    //R1.01 A new state (preset/project load) forces everything to be recalculated.
+    MAKO_PROF_START(tSettings);
+    Settings_Snapshot();
+    bool ForceAll = Settings_Force.exchange(false);
+    if (ForceAll || (Settings_Dirty != 0)) Settings_Update(ForceAll);
+
+    //R1.01 Automation moves from last block's values to these over this block. A new state jumps straight there.
+    Ramp_Start(ForceAll, buffer.getNumSamples());
+
+    //R1.01 Quality can be automated and offline renders switch to the best quality.
+    int Factor = OS_ChooseFactor();
+    if (Factor != OS_Factor) OS_SetFactor(Factor);
+
+    //R1.01 A new shaper mode starts from a clean state. The reference path always uses tanhf.
+    int Order = Engine_Reference ? MAKO_ADAA_OFF : juce::jlimit(MAKO_ADAA_OFF, MAKO_ADAA_2ND, int(Block_State.Setting[e_Shaper]));
+    if (Order != Shaper_Order)
+    {
+        Shaper_Order = Order;
+        Shaper_Reset();
+    }
+    MAKO_PROF_STOP(tSettings, MAKO_PROF_SETTINGS);
 
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
@@ -179,16 +457,73 @@ void MakoBiteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // This is here to avoid people getting screaming feedback
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+    //R1.01 Mono in, stereo out. Both sides get the input, so the block is dual mono and done once.
+    int numInputs = totalNumInputChannels;
+    if ((numInputs == 1) && (totalNumOutputChannels == 2))
+    {
+        buffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
+        numInputs = 2;
+    }
+    for (auto i = numInputs; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
+    //R1.01 Block engine. All channels are processed together, one channel per SIMD lane.
+    //R1.01 Large host blocks are split to fit our preallocated lane buffer.
+    //R1.01 While Low/High are being moved, use short pieces so the filters follow the knob smoothly.
+    //R1.01 We only have state for the channels prepareToPlay saw. Hosts must call it again after a layout change.
+    const int numChannels = juce::jmin(numInputs, Engine_Channels);
+    Meter_Begin(buffer, numChannels);
+    Mono_Check(buffer, numChannels);
+    if ((!Engine_Reference) && (0 < Engine_BlockMax))
+    {
+        //R1.01 Silent input. If we already rang out there is nothing to do.
+        bool InputSilent = Silence_Input(buffer, numChannels);
+        if (!InputSilent)
+        {
+            Silence_Samples = 0;
+            Silence_Idle = false;
+        }
+        else if (Silence_Idle)
+        {
+            for (int channel = 0; channel < numChannels; ++channel)
+                buffer.clear(channel, 0, buffer.getNumSamples());
+            //R1.01 Internal rate mode. Move the (silent) queues on as if this block had been processed, so the
+            //R1.01 next note is cut into the same Rate_Factor groups whatever size the host blocks are.
+            if (1 < Rate_Factor)
+            {
+                Rate_InCount = (Rate_InCount + buffer.getNumSamples()) % Rate_Factor;
+                Rate_OutCount = Rate_Factor - 1 - Rate_InCount;
+            }
+            Meter_End(buffer, numChannels);
+            return;
+        }
+        else
+            Silence_Samples += buffer.getNumSamples();
+
+        auto* const* chData = buffer.getArrayOfWritePointers();
+        int Chunk = Block_State.Ramp_Filters ? juce::jmin(Engine_BlockMax, Ramp_FilterStep) : Engine_BlockMax;
+        if (1 < Rate_Factor)
+            MakoOD_ProcessRate(chData, numChannels, buffer.getNumSamples(), Chunk);
+        else
+            for (int start = 0; start < buffer.getNumSamples(); start += Chunk)
+                MakoOD_ProcessBlock(chData, numChannels, start, juce::jmin(Chunk, buffer.getNumSamples() - start));
+        Mono_Finish(buffer, numChannels);
+
+        if (InputSilent && Silence_Settled(buffer, numChannels)) Silence_Enter();
+        Meter_End(buffer, numChannels);
+        return;
+    }
+
     // This is the place where you'd normally do the guts of your plugin's
     // audio processing...
     // Make sure to reset the state if your inner loop is processing
     // the samples and the outer loop is handling the channels.
     // Alternatively, you can process the samples with the channels
     // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    //R1.01 This per sample code is now our REFERENCE path. See Engine_UseScalarReference.
+    //R1.01 It keeps the original behavior: settings change at the block edge, no ramps.
+    //R1.01 Dual mono only works out channel 0.
+    for (int channel = 0; channel < (Mono_Dual ? 1 : numChannels); ++channel)
     {
         auto* channelData = buffer.getWritePointer (channel);
 
@@ -201,6 +536,8 @@ void MakoBiteAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
             channelData[samp] = tS;                //R1.00 Write our modified sample back into the sample buffer.
         }
     }
+    Mono_Finish(buffer, numChannels);
+    Meter_End(buffer, numChannels);
 }
 
 //==============================================================================
@@ -224,6 +561,7 @@ void MakoBiteAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     
     //R1.00 Save our parameters to file/DAW.
     auto state = parameters.copyState();
+    state.setProperty("program", Program_Current.load(), nullptr);     //R1.01 Just so the host shows the right name.
     std::unique_ptr<juce::XmlElement> xml(state.createXml());
     copyXmlToBinary(*xml, destData);
 
@@ -240,50 +578,23 @@ void MakoBiteAudioProcessor::setStateInformation (const void* data, int sizeInBy
     if (xmlState.get() != nullptr)
         if (xmlState->hasTagName(parameters.state.getType()))
             parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
-
-    //R1.00 Force our settings to update.
-    Setting[e_Gain] = makoGetParmValue_float("gain");
-    Setting[e_NGate] = makoGetParmValue_float("ngate");
-    Setting[e_Low] = makoGetParmValue_int("low");
-    Setting[e_High] = makoGetParmValue_int("high");
-    Setting[e_Drive] = makoGetParmValue_float("drive");
-    Setting[e_EnhLow] = makoGetParmValue_float("enhlow");
-    Setting[e_EnhHigh] = makoGetParmValue_float("enhhigh");
-    Setting[e_Mix] = makoGetParmValue_float("mix");
+    Program_Current = juce::jlimit(0, getNumPrograms() - 1, int(parameters.state.getProperty("program", 0)));
 
     //R1.00 ALL of our settings have changed. Force all settings to be recalculated.
-    Settings_Update(true);
-
-}
-
-int MakoBiteAudioProcessor::makoGetParmValue_int(juce::String Pstring)
-{
-    //R1.00 Read a parameter and force it to a certain type if it exists.
-    auto parm = parameters.getRawParameterValue(Pstring);
-    if (parm != NULL)
-        return int(parm->load());
-    else
-        return 0;
-}
+    //R1.01 This may be called while audio is running, so just flag it. processBlock does the work.
+    Settings_Force = true;
 
-float MakoBiteAudioProcessor::makoGetParmValue_float(juce::String Pstring)
-{
-    //R1.00 Read a parameter and force it to a certain type if it exists.
-    auto parm = parameters.getRawParameterValue(Pstring);
-    if (parm != NULL)
-        return float(parm->load());
-    else
-        return 0.0f;
 }
 
 float MakoBiteAudioProcessor::makoNoiseGate(float tSample, int channel)
 {
     //R2.00 Create a volume envelope based on Signal Average.
-    Pedal_NGate_Fac[channel] = Signal_AVG[channel] * 10000.0f * (1.1f - Setting[e_NGate]);
-    if (1.0f < Pedal_NGate_Fac[channel]) Pedal_NGate_Fac[channel] = 1.0f;
+    float& NGateFac = Pedal_NGate_Fac(channel);
+    NGateFac = Signal_AVG(channel) * 10000.0f * (1.1f - Block_State.Setting[e_NGate]);
+    if (1.0f < NGateFac) NGateFac = 1.0f;
 
     //R1.00 Apply our vol envelope to the audio data sample.
-    return tSample * Pedal_NGate_Fac[channel];
+    return tSample * NGateFac;
 }
 
 
@@ -298,19 +609,19 @@ juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
 float MakoBiteAudioProcessor::Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn)
 {
     //R1.00 This applies an audio filter to our sample data. Coeffs are precalc'd. 
-    float tS = tSample;
-
-    fn->xn0[channel] = tS;
-    tS = fn->a0 * fn->xn0[channel] + fn->a1 * fn->xn1[channel] + fn->a2 * fn->xn2[channel] - fn->b1 * fn->yn1[channel] - fn->b2 * fn->yn2[channel];
-    fn->xn2[channel] = fn->xn1[channel]; fn->xn1[channel] = fn->xn0[channel]; fn->yn2[channel] = fn->yn1[channel]; fn->yn1[channel] = tS;
+    tp_filter_hist& h = Filter_Hist[size_t(fn->Slot * Engine_Groups * MAKO_LANES + channel)];
+    float tS = fn->a0 * tSample + fn->a1 * h.xn1 + fn->a2 * h.xn2 - fn->b1 * h.yn1 - fn->b2 * h.yn2;
+    h.xn2 = h.xn1; h.xn1 = tSample; h.yn2 = h.yn1; h.yn1 = tS;
 
     return tS;
 }
 
-void MakoBiteAudioProcessor::Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn)
+void MakoBiteAudioProcessor::Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn, float Fs)
 {
     //R1.00 Second order parametric/peaking boost filter with constant-Q
-    float K = pi2 * (Fc * .5f) / SampleRate;
+    //R1.01 Fs lets us calc filters for the oversampled rate. 0 means use SampleRate.
+    if (Fs <= 0.0f) Fs = SampleRate;
+    float K = pi2 * (Fc * .5f) / Fs;
     float K2 = K * K;
     float V0 = pow(10.0, Gain_dB / 20.0);
 
@@ -325,8 +636,47 @@ void MakoBiteAudioProcessor::Filter_BP_Coeffs(float Gain_dB, float Fc, float Q,
     fn->a2 = g * dd;
     fn->b1 = b * dd;
     fn->b2 = d * dd;
-    fn->c0 = 1.0f;
-    fn->d0 = 0.0f;
+}
+
+void MakoBiteAudioProcessor::Filter_SetCoeffs(const tp_coeff5& c, tp_filter* fn)
+{
+    //R1.01 Precalculated coeffs into a filter. Its Slot (state) stays the same.
+    fn->a0 = c.a0;
+    fn->a1 = c.a1;
+    fn->a2 = c.a2;
+    fn->b1 = c.b1;
+    fn->b2 = c.b2;
+}
+
+void MakoBiteAudioProcessor::Filter_BP_Table(const tp_coeff_table* tb, float Fc, tp_filter* fn, float Fs)
+{
+    //R1.01 Same filter as Filter_BP_Coeffs(18 dB, Fc, .707) but from a table. 
+    //R1.01 Falls back to the full calc if there is no table or Fc is off the end.
+    tp_coeff5 c;
+    if ((tb == nullptr) || (!tb->Lookup(Fc, c)))
+    {
+        Filter_BP_Coeffs(18.0f, Fc, .707f, fn, Fs);
+        return;
+    }
+    Filter_SetCoeffs(c, fn);
+}
+
+void MakoBiteAudioProcessor::Coeff_BuildTables()
+{
+    //R1.01 Tables cover the Low/High knob ranges. The High filter also runs oversampled, so it gets one per factor.
+    auto Calc = [this](float Fc, float Fs) -> tp_coeff5
+    {
+        tp_filter f = {};
+        Filter_BP_Coeffs(18.0f, Fc, .707f, &f, Fs);
+        return { f.a0, f.a1, f.a2, f.b1, f.b2 };
+    };
+    const juce::NormalisableRange<float>& LowRange = Parm_Object[e_Low]->getNormalisableRange();
+    const juce::NormalisableRange<float>& HighRange = Parm_Object[e_High]->getNormalisableRange();
+
+    Coeff_Low = MakoCoeffTable_Get("bp18q707", SampleRate, int(LowRange.start), int(LowRange.end), Calc);
+    for (int s = 0; s <= MAKO_OS_MAXSTAGES; s++)
+        Coeff_High[s] = MakoCoeffTable_Get("bp18q707", SampleRate * float(1 << s), int(HighRange.start), int(HighRange.end), Calc);
+    Coeff_HighOS = Coeff_High[0].get();
 }
 
 void MakoBiteAudioProcessor::Filter_LP_Coeffs(float fc, tp_filter* fn)
@@ -357,50 +707,50 @@ float MakoBiteAudioProcessor::MakoOD_ProcessAudio(float tSample, int channel)
     float tS_Enh;
 
     //R1.00 Calc Low Frequency Band Pass filter. 
-    float tS = Filter_Calc_BiQuad(tSample, channel, &makoF_OD_Low);
+    float tS = Filter_Calc_BiQuad(tSample, channel, &Block_State.makoF_OD_Low);
 
     //R1.00 Noise gate. Helps to Remove some Highs before testing Noise.
     //R1.00 So perform this action after the LOW filter.
-    if (0.0f < Setting[e_NGate])
+    if (0.0f < Block_State.Setting[e_NGate])
     {
         //R1.00 Track our Input Signal Average (Absolute vals).
-        Signal_AVG[channel] = (Signal_AVG[channel] * .995) + (abs(tS) * .005);
+        Signal_AVG(channel) = (Signal_AVG(channel) * .995) + (abs(tS) * .005);
 
         //R1.00 Apply Noise gate.
         tS = makoNoiseGate(tS, channel);
     }
 
     //R1.00 Enhance the high freqs a little.
-    if (0.0f < Setting[e_EnhHigh])
+    if (0.0f < Block_State.Setting[e_EnhHigh])
     {
-        tS_Enh = Filter_Calc_BiQuad(tS, channel, &makoF_OD_EnhHigh);
-        tS += tanhf(tS_Enh * Setting[e_EnhHigh]);
+        tS_Enh = Filter_Calc_BiQuad(tS, channel, &Block_State.makoF_OD_EnhHigh);
+        tS += tanhf(tS_Enh * Block_State.Setting[e_EnhHigh]);
     }
 
-    tS = Filter_Calc_BiQuad(tS, channel, &makoF_OD_High);
+    tS = Filter_Calc_BiQuad(tS, channel, &Block_State.makoF_OD_High);
 
     //R1.00 Make a copy of the cleanish filtered signal. Includes EnhHigh.
     float tS2 = tS * .25f;
 
     //R1.00 Apply gain. mix of clean and ODHT.
-    tS = tanhf(tS * (.01f + (Setting[e_Drive] * Setting[e_Drive]) * 10.0f));
+    tS = tanhf(tS * (.01f + (Block_State.Setting[e_Drive] * Block_State.Setting[e_Drive]) * 10.0f));
         
     //R1.00 Apply Clean to OD blend.
-    tS = ((1.0f - Setting[e_Mix]) * tS2) + (Setting[e_Mix] * tS);
+    tS = ((1.0f - Block_State.Setting[e_Mix]) * tS2) + (Block_State.Setting[e_Mix] * tS);
 
     //R1.00 Reduce gain, tanhf pushes the signal to the limits (-1,1).
     //R1.00 We could have a 1.0f + 1.0f situation, so reduce more then 50% (25% used here).
     tS *= .25f;
 
     //R1.00 Enhance the LOW/MID freqs a little.
-    if (0.0f < Setting[e_EnhLow])
+    if (0.0f < Block_State.Setting[e_EnhLow])
     {
-        tS_Enh = Filter_Calc_BiQuad(tS, channel, &makoF_OD_EnhLow);
-        tS += tanhf(tS_Enh * Setting[e_EnhLow]);
+        tS_Enh = Filter_Calc_BiQuad(tS, channel, &Block_State.makoF_OD_EnhLow);
+        tS += tanhf(tS_Enh * Block_State.Setting[e_EnhLow]);
     }
 
     //R1.00 Volume/Gain adjust.
-    tS = tS * Setting[e_Gain];
+    tS = tS * Block_State.Setting[e_Gain];
 
     //R1.00 Clip the signal to just below -1/1 so the audio engine does not crash. 
     //R1.00 Need a var here to let user know they are clipping. For now we will assume
@@ -408,17 +758,789 @@ float MakoBiteAudioProcessor::MakoOD_ProcessAudio(float tSample, int channel)
     if (tS < -.9999f)
     {
         tS = -.999f;
-        AudioIsClipping = true;
+        Meter_Clips++;
     }
     if (.9999f < tS)
     {
         tS = .999f;
-        AudioIsClipping = true;
+        Meter_Clips++;
     }
 
     return tS;
 }
 
+void MakoBiteAudioProcessor::Filter_Reset(tp_filter* fn)
+{
+    //R1.01 Clear a filters history in every lane group. Coeffs are left alone.
+    for (tp_lane_state& Hot : Engine_Hot)
+    {
+        std::fill(std::begin(Hot.Filter[fn->Slot].S1), std::end(Hot.Filter[fn->Slot].S1), 0.0f);
+        std::fill(std::begin(Hot.Filter[fn->Slot].S2), std::end(Hot.Filter[fn->Slot].S2), 0.0f);
+    }
+    const size_t LaneCount = Engine_Hot.size() * MAKO_LANES;
+    std::fill(Filter_Hist.begin() + fn->Slot * LaneCount, Filter_Hist.begin() + (fn->Slot + 1) * LaneCount, tp_filter_hist());
+}
+
+void MakoBiteAudioProcessor::Filter_Load4(tp_filter* fn, tp_filter4& f4, int Group)
+{
+    //R1.01 Copy a filter into SIMD registers. Coeffs are the same for every lane, states are per channel.
+    const tp_lane_state& Hot = Engine_Hot[size_t(Group)];
+    f4.a0 = mako_set1(fn->a0);
+    f4.a1 = mako_set1(fn->a1);
+    f4.a2 = mako_set1(fn->a2);
+    f4.b1 = mako_set1(fn->b1);
+    f4.b2 = mako_set1(fn->b2);
+    f4.s1 = mako_load(Hot.Filter[fn->Slot].S1);
+    f4.s2 = mako_load(Hot.Filter[fn->Slot].S2);
+}
+
+void MakoBiteAudioProcessor::Filter_Store4(tp_filter* fn, const tp_filter4& f4, int Group)
+{
+    //R1.01 Write the SIMD filter state back for the next block. Coeffs are never written back.
+    tp_lane_state& Hot = Engine_Hot[size_t(Group)];
+    mako_store(Hot.Filter[fn->Slot].S1, f4.s1);
+    mako_store(Hot.Filter[fn->Slot].S2, f4.s2);
+}
+
+inline mako_f4 MakoBiteAudioProcessor::Filter_Calc_BiQuad4(mako_f4 tS, tp_filter4& f4)
+{
+    //R1.01 Same filter as Filter_Calc_BiQuad, but for every channel at once.
+    //R1.01 Transposed direct form II: the input is used as soon as it arrives and only two
+    //R1.01 states carry over, so there is no history to shuffle along each sample.
+    mako_f4 y = f4.a0 * tS + f4.s1;
+    f4.s1 = f4.a1 * tS - f4.b1 * y + f4.s2;
+    f4.s2 = f4.a2 * tS - f4.b2 * y;
+
+    return y;
+}
+
+void MakoBiteAudioProcessor::MakoOD_ProcessBlock(float* const* chData, int numChannels, int start, int numSamples)
+{
+    //R1.01 Block version of MakoOD_ProcessAudio. Keep the two in step!
+    //R1.01 Each channel lives in its own SIMD lane. Channels are done in groups of MAKO_LANES,
+    //R1.01 so channels 0-3 are group 0, 4-7 group 1, etc. Unused lanes in the last group carry silence.
+    float* Lanes = Engine_Lanes.data();
+
+    //R1.01 Where our automation ramps are for this piece of the host block. Same for every group.
+    Ramp_Chunk(start, numSamples);
+
+    for (int Group = 0; Group * MAKO_LANES < numChannels; Group++)
+    {
+        const int First = Group * MAKO_LANES;
+        const int GroupChannels = juce::jmin(MAKO_LANES, numChannels - First);
+
+        //R1.01 Interleave this group's channels into our lane buffer.
+        for (int channel = 0; channel < MAKO_LANES; channel++)
+        {
+            if (channel < GroupChannels)
+            {
+                const float* channelData = chData[First + channel] + start;
+                for (int samp = 0; samp < numSamples; samp++) Lanes[samp * MAKO_LANES + channel] = channelData[samp];
+            }
+            else
+            {
+                for (int samp = 0; samp < numSamples; samp++) Lanes[samp * MAKO_LANES + channel] = 0.0f;
+            }
+        }
+
+        MakoOD_ProcessLanes(Lanes, numSamples, Group);
+
+        //R1.01 Write the lanes back to the host channels. Dual mono copies channel 0 later (Mono_Finish).
+        for (int channel = 0; channel < (Mono_Dual ? 1 : GroupChannels); channel++)
+        {
+            float* channelData = chData[First + channel] + start;
+            for (int samp = 0; samp < numSamples; samp++) channelData[samp] = Lanes[samp * MAKO_LANES + channel];
+        }
+    }
+}
+
+void MakoBiteAudioProcessor::MakoOD_ProcessLanes(float* Lanes, int numSamples, int Group)
+{
+    //R1.01 Low filter and Noise gate always run at SampleRate.
+    MAKO_PROF_START(tPre);
+    MakoOD_Block_Pre(Lanes, numSamples, Group);
+    MAKO_PROF_STOP(tPre, MAKO_PROF_LOWGATE);
+
+    //R1.01 The distorting stages run oversampled to keep aliasing down.
+    if (1 < OS_Factor)
+    {
+        MAKO_PROF_START(tUp);
+        float* OSData = Engine_OS.Up(Lanes, numSamples, Group);
+        MAKO_PROF_STOP(tUp, MAKO_PROF_OSUP);
+        MAKO_PROF_START(tCore);
+        MakoOD_Block_Core(OSData, numSamples * OS_Factor, Group);
+        MAKO_PROF_STOP(tCore, MAKO_PROF_CORE);
+        MAKO_PROF_START(tDown);
+        Engine_OS.Down(OSData, Lanes, numSamples, Group);
+        MAKO_PROF_STOP(tDown, MAKO_PROF_OSDOWN);
+    }
+    else
+    {
+        MAKO_PROF_START(tCore);
+        MakoOD_Block_Core(Lanes, numSamples, Group);
+        MAKO_PROF_STOP(tCore, MAKO_PROF_CORE);
+    }
+
+    //R1.01 Volume and clipping.
+    MAKO_PROF_START(tPost);
+    MakoOD_Block_Post(Lanes, numSamples);
+    MAKO_PROF_STOP(tPost, MAKO_PROF_CLIP);
+}
+
+void MakoBiteAudioProcessor::MakoOD_ProcessRate(float* const* chData, int numChannels, int numSamples, int Chunk)
+{
+    //R1.01 Internal rate mode. Host blocks can be any size, but the resampler needs whole Rate_Factor groups.
+    //R1.01 So host samples are queued in Rate_In, every whole group is taken down to SampleRate, processed
+    //R1.01 and brought back up into Rate_Out, and the host gets the oldest samples from Rate_Out.
+    //R1.01 Rate_In + Rate_Out always hold Rate_Factor - 1 samples between them, so Rate_Out never runs dry.
+    const int R = Rate_Factor;
+    float* Lanes = Engine_Lanes.data();
+
+    for (int pos = 0; pos < numSamples; )
+    {
+        const int Take = juce::jmin(numSamples - pos, Chunk * R - Rate_InCount);
+        const int Ready = (Rate_InCount + Take) / R;     //R1.01 Samples at SampleRate we can make.
+        const int Made = Ready * R;                       //R1.01 Host samples they turn back into.
+
+        //R1.01 Ramps are in host samples. The queued input started a little before pos.
+        Ramp_Chunk(juce::jmax(0, pos - Rate_InCount), Made);
+
+        for (int Group = 0; Group * MAKO_LANES < numChannels; Group++)
+        {
+            const int First = Group * MAKO_LANES;
+            const int GroupChannels = juce::jmin(MAKO_LANES, numChannels - First);
+            float* In = Rate_In[Group].data();
+            float* Out = Rate_Out[Group].data();
+
+            //R1.01 Queue this group's host samples, interleaved.
+            float* Dst = In + Rate_InCount * MAKO_LANES;
+            for (int channel = 0; channel < MAKO_LANES; channel++)
+            {
+                if (channel < GroupChannels)
+                {
+                    const float* channelData = chData[First + channel] + pos;
+                    for (int samp = 0; samp < Take; samp++) Dst[samp * MAKO_LANES + channel] = channelData[samp];
+                }
+                else
+                {
+                    for (int samp = 0; samp < Take; samp++) Dst[samp * MAKO_LANES + channel] = 0.0f;
+                }
+            }
+
+            //R1.01 Down, process, back up. Keep any part group for next time.
+            if (0 < Ready)
+            {
+                MAKO_PROF_START(tDown);
+                Engine_Rate.Down(In, Lanes, Ready, Group);
+                MAKO_PROF_STOP(tDown, MAKO_PROF_RATE);
+                MakoOD_ProcessLanes(Lanes, Ready, Group);
+                MAKO_PROF_START(tUp);
+                float* Back = Engine_Rate.Up(Lanes, Ready, Group);
+                MAKO_PROF_STOP(tUp, MAKO_PROF_RATE);
+                std::memcpy(Out + Rate_OutCount * MAKO_LANES, Back, sizeof(float) * size_t(Made) * MAKO_LANES);
+                std::memmove(In, In + Made * MAKO_LANES, sizeof(float) * size_t(Rate_InCount + Take - Made) * MAKO_LANES);
+            }
+
+            //R1.01 Hand the oldest Take samples back to the host.
+            for (int channel = 0; channel < (Mono_Dual ? 1 : GroupChannels); channel++)
+            {
+                float* channelData = chData[First + channel] + pos;
+                for (int samp = 0; samp < Take; samp++) channelData[samp] = Out[samp * MAKO_LANES + channel];
+            }
+            std::memmove(Out, Out + Take * MAKO_LANES, sizeof(float) * size_t(Rate_OutCount + Made - Take) * MAKO_LANES);
+        }
+
+        Rate_InCount += Take - Made;
+        Rate_OutCount += Made - Take;
+        pos += Take;
+    }
+}
+
+void MakoBiteAudioProcessor::MakoOD_Block_Pre(float* Lanes, int numSamples, int Group)
+{
+    //R1.01 Pick the kernel once per block. The gate is off only when NGate is 0 for the whole block.
+    if ((0.0f < Block_State.Ramp_From[e_NGate]) || (0.0f < Block_State.Ramp_To[e_NGate]))
+        MakoOD_Block_PreT<true>(Lanes, numSamples, Group);
+    else
+        MakoOD_Block_PreT<false>(Lanes, numSamples, Group);
+}
+
+template <bool UseNGate>
+void MakoBiteAudioProcessor::MakoOD_Block_PreT(float* Lanes, int numSamples, int Group)
+{
+    //R1.01 Convert the settings once here. NGate can be ramping, so it is stepped per sample.
+    mako_f4 vNGateSet = mako_set1(Block_State.Ramp_Val[e_NGate]);
+    const mako_f4 vNGateStep = mako_set1(Block_State.Ramp_Step[e_NGate]);
+    const mako_f4 vNGateTop = mako_set1(1.1f);
+    const mako_f4 vOne = mako_set1(1.0f);
+    const mako_f4 vAvgKeep = mako_set1(.995f);
+    const mako_f4 vAvgAdd = mako_set1(.005f);
+    const mako_f4 vAvgScale = mako_set1(10000.0f);
+
+    //R1.01 Pull the filter and gate into locals so they stay in registers for the whole block.
+    tp_filter4 fLow;
+    Filter_Load4(&Block_State.makoF_OD_Low, fLow, Group);
+    float* pAVG = Engine_Hot[size_t(Group)].AVG;
+    float* pNGateFac = Engine_Hot[size_t(Group)].NGateFac;
+    mako_f4 vAVG = mako_load(pAVG);
+    mako_f4 vNGateFac = mako_load(pNGateFac);
+
+    for (int samp = 0; samp < numSamples; samp++)
+    {
+        //R1.01 Low filter then Noise gate.
+        mako_f4 tS = Filter_Calc_BiQuad4(mako_load(Lanes + samp * MAKO_LANES), fLow);
+        if constexpr (UseNGate)
+        {
+            vNGateSet = vNGateSet + vNGateStep;
+            vAVG = (vAVG * vAvgKeep) + (mako_abs(tS) * vAvgAdd);
+            vNGateFac = mako_min(vAVG * vAvgScale * (vNGateTop - vNGateSet), vOne);
+            tS = tS * vNGateFac;
+        }
+        mako_store(Lanes + samp * MAKO_LANES, tS);
+    }
+
+    Filter_Store4(&Block_State.makoF_OD_Low, fLow, Group);
+    mako_store(pAVG, vAVG);
+    mako_store(pNGateFac, vNGateFac);
+}
+
+void MakoBiteAudioProcessor::MakoOD_Block_Core(float* Lanes, int numSamples, int Group)
+{
+    //R1.01 Work out which optional stages are on for this block.
+    //R1.01 Mix can be ramping, so it only skips the blend when it is 1 at both ends of the block.
+    int Stages = 0;
+    if (0.0f < Block_State.Setting[e_EnhHigh]) Stages |= MAKO_STAGE_ENHHIGH;
+    if (0.0f < Block_State.Setting[e_EnhLow]) Stages |= MAKO_STAGE_ENHLOW;
+    if ((Block_State.Ramp_From[e_Mix] < 1.0f) || (Block_State.Ramp_To[e_Mix] < 1.0f)) Stages |= MAKO_STAGE_BLEND;
+
+    //R1.01 ADAA shapers do not use tanh at all, so they are one kernel set each.
+    if (Shaper_Order == MAKO_ADAA_1ST) { MakoOD_Block_CoreS<MAKO_TANH_EXACT, MAKO_ADAA_1ST>(Lanes, numSamples, Group, Stages); return; }
+    if (Shaper_Order == MAKO_ADAA_2ND) { MakoOD_Block_CoreS<MAKO_TANH_EXACT, MAKO_ADAA_2ND>(Lanes, numSamples, Group, Stages); return; }
+
+    //R1.01 Pick the tanh version once per block, not once per sample.
+    switch (Tanh_Tier)
+    {
+    case MAKO_TANH_EXACT:     MakoOD_Block_CoreS<MAKO_TANH_EXACT, MAKO_ADAA_OFF>(Lanes, numSamples, Group, Stages); break;
+    case MAKO_TANH_PIECEWISE: MakoOD_Block_CoreS<MAKO_TANH_PIECEWISE, MAKO_ADAA_OFF>(Lanes, numSamples, Group, Stages); break;
+    case MAKO_TANH_CLAMPED:   MakoOD_Block_CoreS<MAKO_TANH_CLAMPED, MAKO_ADAA_OFF>(Lanes, numSamples, Group, Stages); break;
+    default:                  MakoOD_Block_CoreS<MAKO_TANH_RATIONAL, MAKO_ADAA_OFF>(Lanes, numSamples, Group, Stages); break;
+    }
+}
+
+template <int TanhTier, int AdaaOrder>
+void MakoBiteAudioProcessor::MakoOD_Block_CoreS(float* Lanes, int numSamples, int Group, int Stages)
+{
+    //R1.01 One compiled kernel per mix of optional stages (see MAKO_STAGE_).
+    static_assert(MAKO_STAGE_COMBOS == 8, "Add the new combos here");
+    switch (Stages)
+    {
+    case 0: MakoOD_Block_CoreT<TanhTier, 0, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 1: MakoOD_Block_CoreT<TanhTier, 1, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 2: MakoOD_Block_CoreT<TanhTier, 2, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 3: MakoOD_Block_CoreT<TanhTier, 3, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 4: MakoOD_Block_CoreT<TanhTier, 4, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 5: MakoOD_Block_CoreT<TanhTier, 5, AdaaOrder>(Lanes, numSamples, Group); break;
+    case 6: MakoOD_Block_CoreT<TanhTier, 6, AdaaOrder>(Lanes, numSamples, Group); break;
+    default: MakoOD_Block_CoreT<TanhTier, 7, AdaaOrder>(Lanes, numSamples, Group); break;
+    }
+}
+
+template <int TanhTier, int Stages, int AdaaOrder>
+void MakoBiteAudioProcessor::MakoOD_Block_CoreT(float* Lanes, int numSamples, int Group)
+{
+    //R1.01 EnhHigh, High filter, Drive, Mix and EnhLow. numSamples is at the oversampled rate.
+    //R1.01 Stages is fixed at compile time, so the stages that are off drop out of the loop.
+    constexpr bool UseEnhHigh = (Stages & MAKO_STAGE_ENHHIGH) != 0;
+    constexpr bool UseEnhLow = (Stages & MAKO_STAGE_ENHLOW) != 0;
+    constexpr bool UseBlend = (Stages & MAKO_STAGE_BLEND) != 0;
+    const mako_f4 vEnhHigh = mako_set1(Block_State.Setting[e_EnhHigh]);
+    const mako_f4 vEnhLow = mako_set1(Block_State.Setting[e_EnhLow]);
+    const mako_f4 vQuarter = mako_set1(.25f);
+    const mako_f4 vOne = mako_set1(1.0f);
+    const mako_f4 vDriveMin = mako_set1(.01f);
+    const mako_f4 vDriveScale = mako_set1(10.0f);
+
+    //R1.01 Drive and Mix ramps. We run OS_Factor samples per host sample, so the step is split.
+    const float OSStep = 1.0f / float(OS_Factor);
+    mako_f4 vDriveSet = mako_set1(Block_State.Ramp_Val[e_Drive]);
+    mako_f4 vMix = mako_set1(Block_State.Ramp_Val[e_Mix]);
+    const mako_f4 vDriveStep = mako_set1(Block_State.Ramp_Step[e_Drive] * OSStep);
+    const mako_f4 vMixStep = mako_set1(Block_State.Ramp_Step[e_Mix] * OSStep);
+
+    //R1.01 Use the filters calculated for our running rate.
+    tp_filter* pEnhHigh = (1 < OS_Factor) ? &Block_State.makoF_OS_EnhHigh : &Block_State.makoF_OD_EnhHigh;
+    tp_filter* pHigh = (1 < OS_Factor) ? &Block_State.makoF_OS_High : &Block_State.makoF_OD_High;
+    tp_filter* pEnhLow = (1 < OS_Factor) ? &Block_State.makoF_OS_EnhLow : &Block_State.makoF_OD_EnhLow;
+    tp_filter4 fEnhHigh, fHigh, fEnhLow;
+    Filter_Load4(pEnhHigh, fEnhHigh, Group);
+    Filter_Load4(pHigh, fHigh, Group);
+    Filter_Load4(pEnhLow, fEnhLow, Group);
+    tp_adaa_state* sEnhHigh = &Shaper_EnhHigh[size_t(Group * MAKO_LANES)];
+    tp_adaa_state* sDrive = &Shaper_Drive[size_t(Group * MAKO_LANES)];
+    tp_adaa_state* sEnhLow = &Shaper_EnhLow[size_t(Group * MAKO_LANES)];
+    const int Active = juce::jmin(MAKO_LANES, Engine_Channels - Group * MAKO_LANES);
+    const bool Dup = Mono_Dual;
+
+    for (int samp = 0; samp < numSamples; samp++)
+    {
+        mako_f4 tS = mako_load(Lanes + samp * MAKO_LANES);
+        mako_f4 tS_Enh;
+
+        //R1.01 Enhance highs.
+        if constexpr (UseEnhHigh)
+        {
+            tS_Enh = Filter_Calc_BiQuad4(tS, fEnhHigh);
+            tS = tS + MakoShape<TanhTier, AdaaOrder>(tS_Enh * vEnhHigh, sEnhHigh, Active, Dup);
+        }
+
+        tS = Filter_Calc_BiQuad4(tS, fHigh);
+
+        //R1.01 Drive, clean blend and level drop. At Mix 1 the blend is all drive, so skip it.
+        vDriveSet = vDriveSet + vDriveStep;
+        mako_f4 vDrive = vDriveMin + (vDriveSet * vDriveSet) * vDriveScale;
+        if constexpr (UseBlend)
+        {
+            vMix = vMix + vMixStep;
+            mako_f4 tS2 = tS * vQuarter;
+            tS = MakoShape<TanhTier, AdaaOrder>(tS * vDrive, sDrive, Active, Dup);
+            tS = ((vOne - vMix) * tS2) + (vMix * tS);
+        }
+        else
+            tS = MakoShape<TanhTier, AdaaOrder>(tS * vDrive, sDrive, Active, Dup);
+        tS = tS * vQuarter;
+
+        //R1.01 Enhance low mids.
+        if constexpr (UseEnhLow)
+        {
+            tS_Enh = Filter_Calc_BiQuad4(tS, fEnhLow);
+            tS = tS + MakoShape<TanhTier, AdaaOrder>(tS_Enh * vEnhLow, sEnhLow, Active, Dup);
+        }
+
+        mako_store(Lanes + samp * MAKO_LANES, tS);
+    }
+
+    Filter_Store4(pEnhHigh, fEnhHigh, Group);
+    Filter_Store4(pHigh, fHigh, Group);
+    Filter_Store4(pEnhLow, fEnhLow, Group);
+}
+
+void MakoBiteAudioProcessor::MakoOD_Block_Post(float* Lanes, int numSamples)
+{
+    //R1.01 Volume and the same clip rules as the reference code. Gain may be ramping.
+    mako_f4 vGain = mako_set1(Block_State.Ramp_Val[e_Gain]);
+    const mako_f4 vGainStep = mako_set1(Block_State.Ramp_Step[e_Gain]);
+    const mako_f4 vClipTest = mako_set1(.9999f);
+    const mako_f4 vClipTestN = mako_set1(-.9999f);
+    const mako_f4 vClipVal = mako_set1(.999f);
+    const mako_f4 vClipValN = mako_set1(-.999f);
+    const mako_f4 vOne = mako_set1(1.0f);
+    const mako_f4 vZero = mako_set1(0.0f);
+    mako_f4 vClipped = vZero;
+
+    for (int samp = 0; samp < numSamples; samp++)
+    {
+        vGain = vGain + vGainStep;
+        mako_f4 tS = mako_load(Lanes + samp * MAKO_LANES) * vGain;
+        mako_f4 ClipN = mako_lt(tS, vClipTestN);
+        mako_f4 ClipP = mako_lt(vClipTest, tS);
+        tS = mako_select(ClipN, vClipValN, tS);
+        tS = mako_select(ClipP, vClipVal, tS);
+        vClipped = vClipped + mako_select(mako_or(ClipN, ClipP), vOne, vZero);
+        mako_store(Lanes + samp * MAKO_LANES, tS);
+    }
+
+    //R1.01 Clip counts per lane. Unused lanes are silent so they never count.
+    if (mako_any(mako_lt(vZero, vClipped)))
+    {
+        float Count[MAKO_LANES];
+        mako_store(Count, vClipped);
+        for (int t = 0; t < MAKO_LANES; t++) Meter_Clips += int(Count[t]);
+    }
+}
+
+void MakoBiteAudioProcessor::Meter_Begin(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    //R1.01 The analyzer gets the input the same way, before we write over it.
+    const bool AnalyzerWasOn = Analyzer_On;
+    Analyzer_On = Analyzer_Active.load(std::memory_order_relaxed) && (0 < numChannels);
+    if (Analyzer_On && !AnalyzerWasOn) Analyzer_Sent = tp_analyzer_coeffs();    //R1.01 A newly opened analyzer needs the coeffs too.
+    if (Analyzer_On) Analyzer_Pre.Push(buffer.getReadPointer(0), buffer.getNumSamples());
+
+    //R1.01 Input levels, before we write over the buffer.
+    Meter_On = Meter_Active.load(std::memory_order_relaxed);
+    Meter_Clips = 0;
+    if (!Meter_On) return;
+
+    float Peak = 0.0f;
+    float Sum = 0.0f;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        Peak = juce::jmax(Peak, buffer.getMagnitude(channel, 0, buffer.getNumSamples()));
+        float Rms = buffer.getRMSLevel(channel, 0, buffer.getNumSamples());
+        Sum += Rms * Rms;
+    }
+    Meter_Frame.InPeak = Peak;
+    Meter_Frame.InRms = (0 < numChannels) ? std::sqrt(Sum / float(numChannels)) : 0.0f;
+}
+
+void MakoBiteAudioProcessor::Meter_End(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    if (Analyzer_On)
+    {
+        Analyzer_Post.Push(buffer.getReadPointer(0), buffer.getNumSamples());
+        Analyzer_SendCoeffs();
+    }
+
+    //R1.01 Output levels and gate, then hand the frame to the editor. Dropped if the editor is behind.
+    if (!Meter_On) return;
+
+    float Peak = 0.0f;
+    float Sum = 0.0f;
+    float Gate = 1.0f;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        Peak = juce::jmax(Peak, buffer.getMagnitude(channel, 0, buffer.getNumSamples()));
+        float Rms = buffer.getRMSLevel(channel, 0, buffer.getNumSamples());
+        Sum += Rms * Rms;
+        if (0.0f < Block_State.Setting[e_NGate]) Gate = juce::jmin(Gate, Pedal_NGate_Fac(channel));
+    }
+    Meter_Frame.OutPeak = Peak;
+    Meter_Frame.OutRms = (0 < numChannels) ? std::sqrt(Sum / float(numChannels)) : 0.0f;
+    Meter_Frame.GateGain = Gate;
+    Meter_Frame.Clips = Meter_Clips;
+    Meter_Frame.Samples = buffer.getNumSamples();
+    Meter.Push(Meter_Frame);
+}
+
+void MakoBiteAudioProcessor::Analyzer_SendCoeffs()
+{
+    //R1.01 Send the voicing filters to the analyzer, only when they are not what we sent last time.
+    tp_analyzer_coeffs c;
+    c.Rate = SampleRate;
+    c.EnhHigh = Block_State.Setting[e_EnhHigh];
+    c.EnhLow = Block_State.Setting[e_EnhLow];
+    const tp_filter* Src[4] = { &Block_State.makoF_OD_Low, &Block_State.makoF_OD_High, &Block_State.makoF_OD_EnhHigh, &Block_State.makoF_OD_EnhLow };
+    float* Dst[4] = { c.Low, c.High, c.EnhHighF, c.EnhLowF };
+    for (int t = 0; t < 4; t++)
+    {
+        Dst[t][0] = Src[t]->a0;
+        Dst[t][1] = Src[t]->a1;
+        Dst[t][2] = Src[t]->a2;
+        Dst[t][3] = Src[t]->b1;
+        Dst[t][4] = Src[t]->b2;
+    }
+    if (std::memcmp(&c, &Analyzer_Sent, sizeof(c)) == 0) return;
+
+    Analyzer_Sent = c;
+    Analyzer_Coeffs.Back() = c;
+    Analyzer_Coeffs.Publish();
+}
+
+int MakoBiteAudioProcessor::OS_ChooseFactor()
+{
+    //R1.01 The reference code has no oversampling.
+    if (Engine_Reference) return 1;
+
+    //R1.01 Offline bounces are not time critical, so always use the best quality.
+    if (isNonRealtime()) return 8;
+
+    int Quality = int(Block_State.Setting[e_Quality]);
+    return 1 << juce::jlimit(0, MAKO_OS_MAXSTAGES, Quality);
+}
+
+void MakoBiteAudioProcessor::OS_SetFactor(int Factor)
+{
+    //R1.01 Change the oversampling and recalc the drive section filters for the new rate.
+    Engine_OS.SetFactor(Factor);
+    OS_Factor = Engine_OS.GetFactor();
+
+    float OSRate = SampleRate * OS_Factor;
+    int Stage = 0;
+    while ((1 << Stage) < OS_Factor) Stage++;
+    Filter_SetCoeffs(OS_EnhLowBy[Stage], &Block_State.makoF_OS_EnhLow);
+    Filter_SetCoeffs(OS_EnhHighBy[Stage], &Block_State.makoF_OS_EnhHigh);
+    Coeff_HighOS = Coeff_High[Stage].get();
+    Filter_BP_Table(Coeff_HighOS, Block_State.Setting[e_High], &Block_State.makoF_OS_High, OSRate);
+    Filter_Reset(&Block_State.makoF_OS_EnhLow);
+    Filter_Reset(&Block_State.makoF_OS_EnhHigh);
+    Filter_Reset(&Block_State.makoF_OS_High);
+    Shaper_Reset();
+
+    //R1.01 May be the audio thread, so the host is told later (timerCallback) or by prepareToPlay.
+    Latency_Pending = Latency_Calc();
+}
+
+int MakoBiteAudioProcessor::Latency_Calc() const
+{
+    //R1.01 How much delay the filters add, in host samples.
+    //R1.01 Internal rate mode adds the resampler and the queue (Rate_Latency).
+    return Engine_OS.GetLatency() * Rate_Factor + Rate_Latency;
+}
+
+void MakoBiteAudioProcessor::Shaper_Reset()
+{
+    std::fill(Shaper_EnhHigh.begin(), Shaper_EnhHigh.end(), tp_adaa_state());
+    std::fill(Shaper_Drive.begin(), Shaper_Drive.end(), tp_adaa_state());
+    std::fill(Shaper_EnhLow.begin(), Shaper_EnhLow.end(), tp_adaa_state());
+}
+
+void MakoBiteAudioProcessor::Mono_Check(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    //R1.01 Dual mono when every channel has exactly the samples of channel 0 and their states still match.
+    //R1.01 Once a block differs the states part ways. Matching input brings them back together, so
+    //R1.01 while it matches we keep checking (Mono_Resync) until they are close enough to join up again.
+    Mono_Dual = false;
+    if ((numChannels < 2) || (MAKO_LANES < numChannels)) return;
+
+    bool Same = true;
+    const size_t Bytes = sizeof(float) * size_t(buffer.getNumSamples());
+    for (int channel = 1; Same && (channel < numChannels); ++channel)
+        Same = (std::memcmp(buffer.getReadPointer(0), buffer.getReadPointer(channel), Bytes) == 0);
+    if (Same && !Mono_Synced) Same = Mono_Resync(numChannels);
+
+    Mono_Dual = Same;
+    Mono_Synced = Same;
+}
+
+bool MakoBiteAudioProcessor::Mono_Resync(int numChannels)
+{
+    //R1.01 True when every per channel state of lane group 0 is within Silence_Level of channel 0's.
+    //R1.01 Then channel 0's is copied over, so the lanes are exactly equal again. The difference this
+    //R1.01 makes is below -180 dB, like the silence skip. The reference path waits for exactly equal.
+    const float Level = Engine_Reference ? 0.0f : Silence_Level;
+    auto Near = [Level](double a, double b) { return std::abs(a - b) <= double(Level); };
+    const tp_lane_state& Hot = Engine_Hot[0];
+    const size_t LaneCount = Engine_Hot.size() * MAKO_LANES;
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        for (int Slot = 0; Slot < MAKO_SLOTS; Slot++)
+        {
+            if (!Near(Hot.Filter[Slot].S1[channel], Hot.Filter[Slot].S1[0])) return false;
+            if (!Near(Hot.Filter[Slot].S2[channel], Hot.Filter[Slot].S2[0])) return false;
+            const tp_filter_hist& h = Filter_Hist[Slot * LaneCount + size_t(channel)];
+            const tp_filter_hist& h0 = Filter_Hist[Slot * LaneCount];
+            if (!Near(h.xn1, h0.xn1) || !Near(h.xn2, h0.xn2) || !Near(h.yn1, h0.yn1) || !Near(h.yn2, h0.yn2)) return false;
+        }
+        if (!Near(Hot.AVG[channel], Hot.AVG[0]) || !Near(Hot.NGateFac[channel], Hot.NGateFac[0])) return false;
+        for (const std::vector<tp_adaa_state>* Shaper : { &Shaper_EnhHigh, &Shaper_Drive, &Shaper_EnhLow })
+        {
+            const tp_adaa_state& st = (*Shaper)[size_t(channel)];
+            const tp_adaa_state& st0 = (*Shaper)[0];
+            if (!Near(st.X1, st0.X1) || !Near(st.X2, st0.X2) || !Near(st.F, st0.F) || !Near(st.D, st0.D)) return false;
+        }
+    }
+    if (!Engine_OS.LanesMatch(numChannels, Level)) return false;
+    if (1 < Rate_Factor)
+    {
+        if (!Engine_Rate.LanesMatch(numChannels, Level)) return false;
+        if (!MakoOversampler::Lanes_Match(Rate_In[0].data(), Rate_InCount, numChannels, Level)) return false;
+        if (!MakoOversampler::Lanes_Match(Rate_Out[0].data(), Rate_OutCount, numChannels, Level)) return false;
+    }
+
+    tp_lane_state& HotW = Engine_Hot[0];
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        for (int Slot = 0; Slot < MAKO_SLOTS; Slot++)
+        {
+            HotW.Filter[Slot].S1[channel] = HotW.Filter[Slot].S1[0];
+            HotW.Filter[Slot].S2[channel] = HotW.Filter[Slot].S2[0];
+            Filter_Hist[Slot * LaneCount + size_t(channel)] = Filter_Hist[Slot * LaneCount];
+        }
+        HotW.AVG[channel] = HotW.AVG[0];
+        HotW.NGateFac[channel] = HotW.NGateFac[0];
+        Shaper_EnhHigh[size_t(channel)] = Shaper_EnhHigh[0];
+        Shaper_Drive[size_t(channel)] = Shaper_Drive[0];
+        Shaper_EnhLow[size_t(channel)] = Shaper_EnhLow[0];
+    }
+    Engine_OS.LanesCopy(numChannels);
+    if (1 < Rate_Factor)
+    {
+        Engine_Rate.LanesCopy(numChannels);
+        MakoOversampler::Lanes_Copy(Rate_In[0].data(), Rate_InCount, numChannels);
+        MakoOversampler::Lanes_Copy(Rate_Out[0].data(), Rate_OutCount, numChannels);
+    }
+    return true;
+}
+
+void MakoBiteAudioProcessor::Mono_Finish(juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    //R1.01 Copy channel 0's output and state to the other channels, so they are ready if the next block differs.
+    //R1.01 The block engine already ran every lane on the same input, only the ADAA states were skipped.
+    if (!Mono_Dual) return;
+
+    for (int channel = 1; channel < numChannels; ++channel)
+    {
+        buffer.copyFrom(channel, 0, buffer, 0, 0, buffer.getNumSamples());
+        Shaper_EnhHigh[size_t(channel)] = Shaper_EnhHigh[0];
+        Shaper_Drive[size_t(channel)] = Shaper_Drive[0];
+        Shaper_EnhLow[size_t(channel)] = Shaper_EnhLow[0];
+        Signal_AVG(channel) = Signal_AVG(0);
+        Pedal_NGate_Fac(channel) = Pedal_NGate_Fac(0);
+
+        //R1.01 The reference path only ran channel 0.
+        const size_t LaneCount = Engine_Hot.size() * MAKO_LANES;
+        for (int Slot = 0; Slot < MAKO_SLOTS; Slot++)
+            Filter_Hist[Slot * LaneCount + size_t(channel)] = Filter_Hist[Slot * LaneCount];
+    }
+}
+
+bool MakoBiteAudioProcessor::Silence_Input(const juce::AudioBuffer<float>& buffer, int numChannels) const
+{
+    //R1.01 True if every input sample in this block is below Silence_Level.
+    for (int channel = 0; channel < numChannels; ++channel)
+        if (Silence_Level <= buffer.getMagnitude(channel, 0, buffer.getNumSamples())) return false;
+
+    return true;
+}
+
+bool MakoBiteAudioProcessor::Silence_FilterQuiet(const tp_filter* fn) const
+{
+    for (const tp_lane_state& Hot : Engine_Hot)
+        for (int t = 0; t < MAKO_LANES; t++)
+        {
+            if (Silence_Level <= std::abs(Hot.Filter[fn->Slot].S1[t])) return false;
+            if (Silence_Level <= std::abs(Hot.Filter[fn->Slot].S2[t])) return false;
+        }
+
+    const size_t LaneCount = Engine_Hot.size() * MAKO_LANES;
+    for (size_t t = fn->Slot * LaneCount; t < (fn->Slot + 1) * LaneCount; t++)
+    {
+        const tp_filter_hist& h = Filter_Hist[t];
+        if (Silence_Level <= std::abs(h.xn1)) return false;
+        if (Silence_Level <= std::abs(h.xn2)) return false;
+        if (Silence_Level <= std::abs(h.yn1)) return false;
+        if (Silence_Level <= std::abs(h.yn2)) return false;
+    }
+    return true;
+}
+
+bool MakoBiteAudioProcessor::Silence_Settled(const juce::AudioBuffer<float>& buffer, int numChannels) const
+{
+    //R1.01 Called after a silent block was processed. We have rung out when the oversampler has flushed
+    //R1.01 (its delay lines hold about 2x latency of input), the filters and gate level have decayed and
+    //R1.01 the block we just made is silent too.
+    if (Silence_Samples <= 2 * getLatencySamples()) return false;
+    if (!Silence_Input(buffer, numChannels)) return false;
+    for (const tp_lane_state& Hot : Engine_Hot)
+        for (int t = 0; t < MAKO_LANES; t++)
+            if (Silence_Level <= Hot.AVG[t]) return false;
+
+    return Silence_FilterQuiet(&Block_State.makoF_OD_Low) && Silence_FilterQuiet(&Block_State.makoF_OD_High)
+        && Silence_FilterQuiet(&Block_State.makoF_OD_EnhHigh) && Silence_FilterQuiet(&Block_State.makoF_OD_EnhLow)
+        && Silence_FilterQuiet(&Block_State.makoF_OS_EnhHigh) && Silence_FilterQuiet(&Block_State.makoF_OS_High)
+        && Silence_FilterQuiet(&Block_State.makoF_OS_EnhLow);
+}
+
+void MakoBiteAudioProcessor::Silence_Enter()
+{
+    //R1.01 Zero whatever is left (all below -180 dB) so the next note starts from a clean state
+    //R1.01 exactly like a freshly prepared plugin.
+    Filter_Reset(&Block_State.makoF_OD_Low);
+    Filter_Reset(&Block_State.makoF_OD_High);
+    Filter_Reset(&Block_State.makoF_OD_EnhHigh);
+    Filter_Reset(&Block_State.makoF_OD_EnhLow);
+    Filter_Reset(&Block_State.makoF_OS_EnhHigh);
+    Filter_Reset(&Block_State.makoF_OS_High);
+    Filter_Reset(&Block_State.makoF_OS_EnhLow);
+    for (tp_lane_state& Hot : Engine_Hot)
+    {
+        std::fill(std::begin(Hot.AVG), std::end(Hot.AVG), 0.0f);
+        std::fill(std::begin(Hot.NGateFac), std::end(Hot.NGateFac), 0.0f);
+    }
+    Shaper_Reset();
+    Mono_Synced = true;
+    Engine_OS.Reset();
+    Engine_Rate.Reset();
+    for (std::vector<float>& queue : Rate_In) std::fill(queue.begin(), queue.end(), 0.0f);
+    for (std::vector<float>& queue : Rate_Out) std::fill(queue.begin(), queue.end(), 0.0f);
+    Silence_Idle = true;
+}
+
+double MakoBiteAudioProcessor::Filter_DecaySamples(const tp_filter* fn, float Level) const
+{
+    //R1.01 Samples for a filter's ringing to fall from 1 to Level.
+    //R1.01 Ringing dies at the rate of the slowest pole, a root of z^2 + b1 z + b2.
+    double b1 = fn->b1;
+    double b2 = fn->b2;
+    double disc = b1 * b1 - 4.0 * b2;
+    double r = (disc < 0.0) ? std::sqrt(b2) : .5 * (std::abs(b1) + std::sqrt(disc));
+    if ((r <= 0.0) || (1.0 <= r)) return 0.0;
+
+    return std::log(double(Level)) / std::log(r);
+}
+
+void MakoBiteAudioProcessor::Tail_Update()
+{
+    //R1.01 The filters are in series, so add up how long each one rings. Low and High use the bottom
+    //R1.01 of their knob range, where they ring longest. The oversampled copies ring for the same time.
+    const juce::NormalisableRange<float>& LowRange = Parm_Object[e_Low]->getNormalisableRange();
+    const juce::NormalisableRange<float>& HighRange = Parm_Object[e_High]->getNormalisableRange();
+    tp_filter f = {};
+    double Samples = 0.0;
+    Filter_BP_Coeffs(18.0f, LowRange.start, .707f, &f);
+    Samples += Filter_DecaySamples(&f, Silence_Level);
+    Filter_BP_Coeffs(18.0f, HighRange.start, .707f, &f);
+    Samples += Filter_DecaySamples(&f, Silence_Level);
+    Samples += Filter_DecaySamples(&Block_State.makoF_OD_EnhHigh, Silence_Level);
+    Samples += Filter_DecaySamples(&Block_State.makoF_OD_EnhLow, Silence_Level);
+    Tail_Seconds = Samples / double(SampleRate);
+}
+
+void MakoBiteAudioProcessor::Settings_Snapshot()
+{
+    //R1.01 Read every parameter once so a whole block sees the same values,
+    //R1.01 and note which ones changed so Settings_Update only redoes those.
+    //R1.01 After a program change on the audio thread, each preset value wins until its parameter moves
+    //R1.01 (automation, the editor or the timer's copy) or gets to the preset value.
+    Settings_Dirty = 0;
+    for (int t = 0; t < e_ParmCount; t++)
+    {
+        float Val = Parm_Value[t]->load(std::memory_order_relaxed);
+        if (Program_Hold[t] && ((Val != Program_Raw[t]) || (Val == Program_Value[t]))) Program_Hold[t] = false;
+        if (Program_Hold[t]) Val = Program_Value[t];
+        if (Val != Block_State.Setting[t])
+        {
+            Block_State.Setting[t] = Val;
+            Settings_Dirty |= (1 << t);
+        }
+    }
+}
+
+void MakoBiteAudioProcessor::Ramp_Start(bool Jump, int numSamples)
+{
+    //R1.01 Start a new set of ramps from where the last block ended to the new snapshot.
+    Block_State.Ramp_Len = juce::jmax(1, numSamples);
+    for (int t = 0; t < e_ParmCount; t++)
+    {
+        Block_State.Ramp_From[t] = Jump ? Block_State.Setting[t] : Block_State.Ramp_To[t];
+        Block_State.Ramp_To[t] = Block_State.Setting[t];
+    }
+    Block_State.Ramp_Filters = (Block_State.Ramp_From[e_Low] != Block_State.Ramp_To[e_Low]) || (Block_State.Ramp_From[e_High] != Block_State.Ramp_To[e_High]);
+}
+
+void MakoBiteAudioProcessor::Ramp_Chunk(int start, int numSamples)
+{
+    //R1.01 Values just before sample "start" and the step per sample. A setting that is not moving has a step of 0.
+    //R1.01 start and numSamples are host samples. The step is per sample at SampleRate (Rate_Factor host samples).
+    for (int t = 0; t < e_ParmCount; t++)
+    {
+        float Delta = Block_State.Ramp_To[t] - Block_State.Ramp_From[t];
+        Block_State.Ramp_Val[t] = Block_State.Ramp_From[t] + Delta * (float(start) / float(Block_State.Ramp_Len));
+        Block_State.Ramp_Step[t] = Delta * float(Rate_Factor) / float(Block_State.Ramp_Len);
+    }
+
+    //R1.01 Moving filters jump to where the knob is at the end of this piece. Table lookups, so it is cheap.
+    if (Block_State.Ramp_Filters)
+    {
+        float Frac = float(start + numSamples) / float(Block_State.Ramp_Len);
+        float Low = Block_State.Ramp_From[e_Low] + (Block_State.Ramp_To[e_Low] - Block_State.Ramp_From[e_Low]) * Frac;
+        float High = Block_State.Ramp_From[e_High] + (Block_State.Ramp_To[e_High] - Block_State.Ramp_From[e_High]) * Frac;
+        Filter_BP_Table(Coeff_Low.get(), Low, &Block_State.makoF_OD_Low);
+        Filter_BP_Table(Coeff_High[0].get(), High, &Block_State.makoF_OD_High);
+        if (1 < OS_Factor) Filter_BP_Table(Coeff_HighOS, High, &Block_State.makoF_OS_High, SampleRate * OS_Factor);
+    }
+}
+
 void MakoBiteAudioProcessor::Settings_Update(bool ForceAll)
 {
     //R1.00 Here we verify our settings have not changed. If they did, update them.
@@ -427,20 +1549,17 @@ void MakoBiteAudioProcessor::Settings_Update(bool ForceAll)
     //R1.00 We dont want the editor modifying things and getting weird results.   
 
     //R1.00 Update our Filters. Gain, Drive, Mix, NGate, etc do not need recalc unless you are smoothing the changes.
-    if ((Setting[e_Low] != Setting_Last[e_Low]) || ForceAll)
+    //R1.01 Low/High come from the coeff tables, so this is cheap enough to do every block.
+    if ((Settings_Dirty & (1 << e_Low)) || ForceAll)
     {
-        Setting_Last[e_Low] = Setting[e_Low];
-        Filter_BP_Coeffs(18.0f, Setting[e_Low], .707f, &makoF_OD_Low);
+        Filter_BP_Table(Coeff_Low.get(), Block_State.Setting[e_Low], &Block_State.makoF_OD_Low);
     }
-    if ((Setting[e_High] != Setting_Last[e_High]) || ForceAll)
+    if ((Settings_Dirty & (1 << e_High)) || ForceAll)
     {
-        Setting_Last[e_High] = Setting[e_High];
-        Filter_BP_Coeffs(18.0f, Setting[e_High], .707f, &makoF_OD_High);
+        Filter_BP_Table(Coeff_High[0].get(), Block_State.Setting[e_High], &Block_State.makoF_OD_High);
+        if (1 < OS_Factor) Filter_BP_Table(Coeff_HighOS, Block_State.Setting[e_High], &Block_State.makoF_OS_High, SampleRate * OS_Factor);
     }
-    
 
-    //R1.00 Reduce our SettingChanged flag and limit to 0 (No changes). 
-    SettingsChanged -= 1;
-    if (SettingsChanged < 0) SettingsChanged = 0;
+    Settings_Dirty = 0;
 }
 
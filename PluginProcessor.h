@@ -9,6 +9,39 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MakoSIMD.h"         //R1.01 SIMD lanes for the block engine.
+#include "MakoOversampler.h"  //R1.01 Oversampling around the drive section.
+#include "MakoTanh.h"         //R1.01 Fast tanh approximations.
+#include "MakoADAA.h"         //R1.01 Anti-aliased shapers.
+#include "MakoCoeffTable.h"   //R1.01 Precalculated Low/High filter coeffs.
+#include "MakoMeter.h"        //R1.01 Meter frames for the editor.
+#include "MakoAnalyzer.h"     //R1.01 Spectrum and filter response for the editor.
+#include "MakoProfile.h"      //R1.01 Optional per stage timing (MAKO_PROFILE).
+#include "MakoAudit.h"        //R1.01 Optional real time safety audit (MAKO_RTAUDIT).
+#include "MakoPresetBank.h"   //R1.01 Binary preset banks.
+
+//R1.01 Optional stages of the drive section. Each mix of these gets its own compiled block kernel,
+//R1.01 so a stage that is switched off is not in the loop at all.
+const int MAKO_STAGE_ENHHIGH = 1;
+const int MAKO_STAGE_ENHLOW = 2;
+const int MAKO_STAGE_BLEND = 4;     //R1.01 Mix below 1, some clean signal is blended in.
+const int MAKO_STAGE_COMBOS = 8;
+
+//R1.01 Where each filter keeps its per channel state in tp_lane_state (tp_filter::Slot).
+const int MAKO_SLOT_OD_LOW = 0;
+const int MAKO_SLOT_OD_HIGH = 1;
+const int MAKO_SLOT_OD_ENHHIGH = 2;
+const int MAKO_SLOT_OD_ENHLOW = 3;
+const int MAKO_SLOT_OS_ENHHIGH = 4;
+const int MAKO_SLOT_OS_HIGH = 5;
+const int MAKO_SLOT_OS_ENHLOW = 6;
+const int MAKO_SLOTS = 7;
+
+//R1.01 Internal rate mode. 0 runs everything at the host rate. A rate like 48000 or 96000 runs the OD
+//R1.01 at about that rate when the host is 2x, 4x or 8x faster, behind a half band resampler.
+#ifndef MAKO_INTERNAL_RATE
+ #define MAKO_INTERNAL_RATE 0
+#endif
 
 //==============================================================================
 /**
@@ -17,6 +50,7 @@ class MakoBiteAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::Timer
 {
 public:
     //==============================================================================
@@ -59,18 +93,56 @@ public:
     //R1.00 Create a Parameter VALUETREE object to track our settings for DAW/FILE.
     juce::AudioProcessorValueTreeState parameters;                           
     
-    //R1.00 Create a flag to let editor know we are clipping and show user.
-    bool AudioIsClipping = false;
+    //R1.01 Meters for the editor, including the clip warning. One frame per block, only while
+    //R1.01 an editor has set Meter_Active, so there is no cost when the UI is closed.
+    MakoMeterFifo Meter;
+    std::atomic<bool> Meter_Active { false };
+
+    //R1.01 Spectrum analyzer feed. While an editor has set Analyzer_Active, channel 0 is copied into
+    //R1.01 Analyzer_Pre before the OD and into Analyzer_Post after it, and the voicing coeffs are sent
+    //R1.01 whenever they change. Nothing else happens on the audio thread. See MakoAnalyzer.h.
+    MakoSampleTap Analyzer_Pre;
+    MakoSampleTap Analyzer_Post;
+    MakoTripleBuffer<tp_analyzer_coeffs> Analyzer_Coeffs;
+    std::atomic<bool> Analyzer_Active { false };
+    bool Analyzer_Open = false;     //R1.01 Editor only. The analyzer panel was open, so a reopened editor shows it.
+    float Analyzer_Rate() const { return HostRate; }     //R1.01 The taps run at the host rate.
+
+    //R1.01 Editor size the user last chose (1 = 450x250), so a reopened editor keeps it.
+    float Editor_Scale = 1.0f;
+
+#if MAKO_PROFILE
+    //R1.01 Per stage timing. Cleared in prepareToPlay. Safe to read from any thread.
+    MakoProfiler Profile;
+#endif
 
     //R1.00 Our public variables.
-    int SettingsChanged = 0;
-    int SettingsType = 0;
-    float Setting[20] = {};       //R1.00 Actual Setting value.
-    float Setting_Last[20] = {};  //R1.00 Last set value. Used to know when a VAR has been changed.
+    //R1.01 The block's copy of the parameters is Block_State.Setting, audio thread only.
+    //R1.01 Editors and tools should use the parameters (or Parm_Get) instead.
+    float Parm_Get(int idx) const { return Parm_Value[idx]->load(); }
 
     //R1.00 Define arrays to store our NOISE GATE gain value and the AVERAGE signal level.
-    float Pedal_NGate_Fac[2] = {};
-    float Signal_AVG[2] = {};
+    //R1.01 One per channel. They live in Engine_Hot with the filter states, these find a channel's copy.
+    float& Pedal_NGate_Fac(int channel) { return Engine_Hot[size_t(channel / MAKO_LANES)].NGateFac[channel % MAKO_LANES]; }
+    float& Signal_AVG(int channel) { return Engine_Hot[size_t(channel / MAKO_LANES)].AVG[channel % MAKO_LANES]; }
+    float Pedal_NGate_Fac(int channel) const { return Engine_Hot[size_t(channel / MAKO_LANES)].NGateFac[channel % MAKO_LANES]; }
+
+    //R1.01 Bytes of state the block engine reads and writes every block (Engine_Hot and Block_State), for the bench tool.
+    size_t Engine_HotBytes() const { return Engine_Hot.size() * sizeof(tp_lane_state) + sizeof(tp_block_state); }
+
+    //R1.01 Set to use the original per sample code instead of the block engine. 
+    //R1.01 Kept as our reference so we can always check the fast code sounds the same.
+    //R1.01 Read in prepareToPlay. The two paths keep their own filter history, so a change
+    //R1.01 only takes effect at the next prepareToPlay, which starts both from silence.
+    bool Engine_UseScalarReference = false;
+
+    //R1.01 Which tanh approximation the block engine uses. See MakoTanh.h for error and speed.
+    //R1.01 The reference path always uses the C library tanhf.
+    int Tanh_Tier = MAKO_TANH_TIER;
+
+    //R1.01 Internal rate mode (see MAKO_INTERNAL_RATE). Read in prepareToPlay.
+    //R1.01 The reference path always runs at the host rate.
+    float Engine_InternalRate = MAKO_INTERNAL_RATE;
     
     //R1.00 Define an 'enumerated' type list to make our SETTING and SLIDER code easier.
     //R1.00 Any of our custom SLIDERs you add should have a value added here.
@@ -82,65 +154,255 @@ public:
     const int e_EnhLow = 5;
     const int e_EnhHigh = 6;
     const int e_Mix = 7;
+    const int e_Quality = 8;
+    const int e_Shaper = 9;
+    const int e_ParmCount = 10;
+    const int e_PresetParms = 8;    //R1.01 Parameters saved in a preset. Quality and Shaper are CPU choices, so presets leave them alone.
+
+    //R1.01 Presets. The programs are the factory presets followed by the user bank (see Preset_LoadBank).
+    //R1.01 Message thread only. Loading a bank allocates, switching programs does not.
+    static juce::File Preset_UserBankFile();
+    bool Preset_LoadBank(const juce::File& file, juce::String& error);
+    bool Preset_SaveUserBank(const juce::String& name, juce::String& error);
 
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MakoBiteAudioProcessor)
 
-    //R1.00 Add some funcs to make parameters easier to deal with.
-    int makoGetParmValue_int(juce::String Pstring);
-    float makoGetParmValue_float(juce::String Pstring);
+    //R1.01 Parameter values, looked up once in the constructor. Index with the e_ values.
+    //R1.01 The host, the editor and setStateInformation all write these, so only read them thru Settings_Snapshot.
+    std::atomic<float>* Parm_Value[20] = {};
+    juce::RangedAudioParameter* Parm_Object[20] = {};
+    std::atomic<bool> Settings_Force { true };   //R1.01 Recalc everything on the next block (new state loaded).
+    int Settings_Dirty = 0;                      //R1.01 Bit per e_ value that changed in this block's snapshot.
+    void Settings_Snapshot();
+
+    //R1.01 Program switching. Every bank ever loaded is kept until we are deleted, so the audio
+    //R1.01 thread can keep using the one it read from Preset_Bank while a new one is swapped in.
+    std::vector<std::unique_ptr<MakoPresetBank>> Preset_Banks;
+    std::atomic<MakoPresetBank*> Preset_Bank { nullptr };
+    std::atomic<int> Program_Current { 0 };
+    std::atomic<int> Program_Pending { -1 };    //R1.01 From setCurrentProgram off the message thread. processBlock applies it.
+    std::atomic<int> Program_Sync { -1 };       //R1.01 Program the timer still has to show in the parameters (host, editor).
+
+    //R1.01 Latency changes from the audio thread (Quality automation, offline switching) are only noted here.
+    //R1.01 The timer tells the host on the message thread. prepareToPlay sets it directly.
+    std::atomic<int> Latency_Pending { 0 };
+    int Latency_Calc() const;
+    int Program_MidiBank = 0;                   //R1.01 MIDI bank select (CC0 * 128 + CC32). Audio thread only.
+    //R1.01 Per parameter, use Program_Value instead of the parameter until the parameter moves (automation,
+    //R1.01 the editor, the timer's copy) or reaches Program_Value. Program_Raw is the parameter at the switch.
+    bool Program_Hold[20] = {};
+    float Program_Value[20] = {};
+    float Program_Raw[20] = {};
+    void Program_Apply(int idx);
+    void Program_SetParms(int idx);
+    void Preset_Factory(MakoPresetBank& bank);
+    void timerCallback() override;
 
     //R1.00 The actual funcs that do the audio work.
     float makoNoiseGate(float tSample, int channel);
     float MakoOD_ProcessAudio(float tSample, int channel);
+    void MakoOD_ProcessBlock(float* const* chData, int numChannels, int start, int numSamples);
+    void MakoOD_ProcessLanes(float* Lanes, int numSamples, int Group);
+    void MakoOD_ProcessRate(float* const* chData, int numChannels, int numSamples, int Chunk);
+    void MakoOD_Block_Pre(float* Lanes, int numSamples, int Group);
+    template <bool UseNGate> void MakoOD_Block_PreT(float* Lanes, int numSamples, int Group);
+    void MakoOD_Block_Core(float* Lanes, int numSamples, int Group);
+    template <int TanhTier, int AdaaOrder> void MakoOD_Block_CoreS(float* Lanes, int numSamples, int Group, int Stages);
+    template <int TanhTier, int Stages, int AdaaOrder> void MakoOD_Block_CoreT(float* Lanes, int numSamples, int Group);
+    void MakoOD_Block_Post(float* Lanes, int numSamples);
 
     //R1.00 Some Constants. SampleRate is updated at runtime in PrepareToPlay code. 
     const float pi = 3.14159265f;
     const float pi2 = 6.2831853f;
     const float sqrt2 = 1.4142135f;
     float SampleRate = 48000.0f;     //R1.00 Default value.
+                                     //R1.01 This is the rate the OD runs at. In internal rate mode it is HostRate / Rate_Factor.
+    float HostRate = 48000.0f;       //R1.01 The rate the host gave prepareToPlay.
 
     //R1.00 OUR FILTER VARIABLES
-    struct tp_coeffs {
-        float a0;
-        float a1;
-        float a2;
-        float b1;
-        float b2;
-        float c0;
-        float d0;
+    //R1.01 Just the coeffs. The per channel history is kept apart, by Slot (MAKO_SLOT_), see tp_lane_state.
+    struct tp_filter {
+        int Slot = 0;
+        float a0 = 0.0f;
+        float a1 = 0.0f;
+        float a2 = 0.0f;
+        float b1 = 0.0f;
+        float b2 = 0.0f;
     };
 
-    struct tp_filter {
-        float a0;
-        float a1;
-        float a2;
-        float b1;
-        float b2;
-        float c0;
-        float d0;
-        float xn0[2];
-        float xn1[2];
-        float xn2[2];
-        float yn1[2];
-        float yn2[2];
-        float offset[2];
+    //R1.01 Everything the block engine carries from one block to the next for one lane group, in one
+    //R1.01 cache aligned block: the transposed direct form II state of every filter (two values instead
+    //R1.01 of four) and the gate. With many instances loaded each one's state is only 4 cache lines a
+    //R1.01 group, not 16 vectors spread over the heap. The ADAA states stay apart, plain tanh never reads them.
+    struct alignas(64) tp_lane_state {
+        struct {
+            float S1[MAKO_LANES];
+            float S2[MAKO_LANES];
+        } Filter[MAKO_SLOTS];
+        float AVG[MAKO_LANES];
+        float NGateFac[MAKO_LANES];
+    };
+    static_assert(sizeof(tp_lane_state) == 256, "tp_lane_state should fill exactly 4 cache lines");
+
+    //R1.01 The rest of what the block engine reads every block, one per instance and packed the same way:
+    //R1.01 the parameter snapshot, the automation ramps and the coeffs of every filter. 9 cache lines.
+    struct alignas(64) tp_block_state {
+        //R1.00 Actual Setting value. A copy of the parameters taken at the start of each block.
+        float Setting[20] = {};
+
+        //R1.01 Automation ramps. The block engine slides each setting from last block's value to this
+        //R1.01 block's value, one step per sample, so big host buffers do not zipper. Index with the e_ values.
+        //R1.01 Ramp_Val is the value just before the current chunk, Ramp_Step the change per host sample.
+        float Ramp_From[20] = {};
+        float Ramp_To[20] = {};
+        float Ramp_Val[20] = {};
+        float Ramp_Step[20] = {};
+        int Ramp_Len = 1;
+        bool Ramp_Filters = false;           //R1.01 Low or High is moving this block.
+
+        //R1.00 Define our filters. 
+        tp_filter makoF_OD_Low = { MAKO_SLOT_OD_LOW };
+        tp_filter makoF_OD_High = { MAKO_SLOT_OD_HIGH };
+        tp_filter makoF_OD_EnhHigh = { MAKO_SLOT_OD_ENHHIGH };
+        tp_filter makoF_OD_EnhLow = { MAKO_SLOT_OD_ENHLOW };
+
+        //R1.01 Copies of the drive section filters running at the oversampled rate.
+        //R1.01 Only used when OS_Factor is more than 1. At 1x the normal filters are used.
+        tp_filter makoF_OS_EnhHigh = { MAKO_SLOT_OS_ENHHIGH };
+        tp_filter makoF_OS_High = { MAKO_SLOT_OS_HIGH };
+        tp_filter makoF_OS_EnhLow = { MAKO_SLOT_OS_ENHLOW };
+    };
+    static_assert(sizeof(tp_block_state) == 576, "tp_block_state should fill exactly 9 cache lines");
+
+    //R1.01 The reference path's direct form I history. Only the reference path and silence check use it.
+    //R1.01 The two paths keep their own history. Switching paths mid stream needs a prepareToPlay.
+    struct tp_filter_hist {
+        float xn1;
+        float xn2;
+        float yn1;
+        float yn2;
+    };
+
+    //R1.01 SIMD copy of a filter used inside the block engine. One lane per channel.
+    //R1.01 Loaded from one lane group of a tp_filter at the start of a block and stored back at the end,
+    //R1.01 so the state lives in registers for the whole block.
+    struct tp_filter4 {
+        mako_f4 a0;
+        mako_f4 a1;
+        mako_f4 a2;
+        mako_f4 b1;
+        mako_f4 b2;
+        mako_f4 s1;
+        mako_f4 s2;
     };
 
     //R1.00 FILTERS
     float Filter_Calc_BiQuad(float tSample, int channel, tp_filter* fn);
-    void Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn);
+    void Filter_BP_Coeffs(float Gain_dB, float Fc, float Q, tp_filter* fn, float Fs = 0.0f);
+    void Filter_BP_Table(const tp_coeff_table* tb, float Fc, tp_filter* fn, float Fs = 0.0f);
+    void Filter_SetCoeffs(const tp_coeff5& c, tp_filter* fn);
+    void Filter_Reset(tp_filter* fn);
     void Filter_LP_Coeffs(float fc, tp_filter* fn);
     void Filter_HP_Coeffs(float fc, tp_filter* fn);
+    void Filter_Load4(tp_filter* fn, tp_filter4& f4, int Group);
+    void Filter_Store4(tp_filter* fn, const tp_filter4& f4, int Group);
+    mako_f4 Filter_Calc_BiQuad4(mako_f4 tS, tp_filter4& f4);
 
-    //R1.00 Define our filters. 
-    tp_filter makoF_OD_Low = {};
-    tp_filter makoF_OD_High = {};
-    tp_filter makoF_OD_EnhHigh = {};
-    tp_filter makoF_OD_EnhLow = {};    
+    //R1.01 EnhHigh/EnhLow coeffs for every oversampling stage count (index 0 is 1x). Built in prepareToPlay,
+    //R1.01 so a Quality change on the audio thread only copies them.
+    tp_coeff5 OS_EnhHighBy[MAKO_OS_MAXSTAGES + 1];
+    tp_coeff5 OS_EnhLowBy[MAKO_OS_MAXSTAGES + 1];
+
+    //R1.01 Filter and gate state, one tp_lane_state per lane group. Sized in prepareToPlay.
+    //R1.01 Filter_Hist is MAKO_SLOTS runs of Engine_Groups * MAKO_LANES channels.
+    std::vector<tp_lane_state> Engine_Hot;
+    tp_block_state Block_State;
+    std::vector<tp_filter_hist> Filter_Hist;
+    bool Engine_Reference = false;      //R1.01 Engine_UseScalarReference as prepareToPlay saw it.
+
+    //R1.01 Coeff tables for the Low and High filters, one per Hz of their knob range.
+    //R1.01 High has one per oversampling factor (index 0 = 1x .. 3 = 8x). Built in prepareToPlay.
+    std::shared_ptr<const tp_coeff_table> Coeff_Low;
+    std::shared_ptr<const tp_coeff_table> Coeff_High[MAKO_OS_MAXSTAGES + 1];
+    const tp_coeff_table* Coeff_HighOS = nullptr;    //R1.01 Table for the current OS_Factor.
+    void Coeff_BuildTables();
 
     //R1.00 Handle any paramater changes.
     void Settings_Update(bool ForceAll);
 
+    //R1.01 Automation ramps, see tp_block_state.
+    const int Ramp_FilterStep = 32;      //R1.01 Samples between filter coeff updates while Low/High move.
+    void Ramp_Start(bool Jump, int numSamples);
+    void Ramp_Chunk(int start, int numSamples);
+
+    //R1.01 Silence fast path. Once the input has been silent long enough for every filter to ring out,
+    //R1.01 the states are cleared and processBlock just outputs silence until audio comes back.
+    const float Silence_Level = 1e-9f;     //R1.01 -180 dB. Input, filter states and output below this are silence.
+    int Silence_Samples = 0;               //R1.01 Silent input samples in a row.
+    bool Silence_Idle = false;             //R1.01 Skipping the DSP.
+    bool Silence_Input(const juce::AudioBuffer<float>& buffer, int numChannels) const;
+    bool Silence_Settled(const juce::AudioBuffer<float>& buffer, int numChannels) const;
+    bool Silence_FilterQuiet(const tp_filter* fn) const;
+    void Silence_Enter();
+
+    //R1.01 How long the filters ring after the input stops (the plugin latency is added on top). See Tail_Update.
+    std::atomic<double> Tail_Seconds { 0.0 };
+    double Filter_DecaySamples(const tp_filter* fn, float Level) const;
+    void Tail_Update();
+
+    //R1.01 Meter frame being built for this block. See MakoMeter.h.
+    bool Meter_On = false;
+    int Meter_Clips = 0;                   //R1.01 Clipped samples this block, counted by Post and the reference code.
+    tp_meter_frame Meter_Frame;
+    void Meter_Begin(const juce::AudioBuffer<float>& buffer, int numChannels);
+    void Meter_End(const juce::AudioBuffer<float>& buffer, int numChannels);
+
+    //R1.01 Analyzer taps, called with the meters. Analyzer_Sent is the last coeff set we sent.
+    bool Analyzer_On = false;
+    tp_analyzer_coeffs Analyzer_Sent;
+    void Analyzer_SendCoeffs();
+
+    //R1.01 Block engine work buffer. Samples are interleaved, MAKO_LANES floats per sample.
+    //R1.01 Allocated in prepareToPlay so the audio thread never allocates.
+    std::vector<float> Engine_Lanes;
+    int Engine_BlockMax = 0;
+
+    //R1.01 Channels we have state for. Channels are run MAKO_LANES at a time, one lane group per pass.
+    int Engine_Channels = 0;
+    int Engine_Groups = 0;
+
+    //R1.01 Oversampling. EnhHigh, High, Drive, Mix and EnhLow run at SampleRate * OS_Factor.
+    MakoOversampler Engine_OS;
+    int OS_Factor = 1;
+    int OS_ChooseFactor();
+    void OS_SetFactor(int Factor);
+
+    //R1.01 Shaper mode (MAKO_ADAA_). ADAA shapers remember their last inputs, one state per channel for each
+    //R1.01 of EnhHigh, Drive and EnhLow. Cleared when the mode, the oversampling or silence starts them over.
+    int Shaper_Order = MAKO_ADAA_OFF;
+    std::vector<tp_adaa_state> Shaper_EnhHigh;
+    std::vector<tp_adaa_state> Shaper_Drive;
+    std::vector<tp_adaa_state> Shaper_EnhLow;
+    void Shaper_Reset();
+
+    //R1.01 Dual mono. A mono DI on a stereo track sends the same samples to both sides. Then only channel 0
+    //R1.01 is worked out where that saves time (ADAA shapers, reference path, write back) and copied over.
+    bool Mono_Dual = false;          //R1.01 This block is dual mono.
+    bool Mono_Synced = true;         //R1.01 Every channel's state matches channel 0's.
+    void Mono_Check(const juce::AudioBuffer<float>& buffer, int numChannels);
+    bool Mono_Resync(int numChannels);
+    void Mono_Finish(juce::AudioBuffer<float>& buffer, int numChannels);
+
+    //R1.01 Internal rate mode. Host samples queue in Rate_In until there are whole Rate_Factor groups,
+    //R1.01 processed samples queue in Rate_Out until the host takes them. One vector per lane group.
+    MakoOversampler Engine_Rate;
+    int Rate_Factor = 1;
+    int Rate_Latency = 0;            //R1.01 Resampler + queue delay in host samples. Set in prepareToPlay.
+    std::vector<std::vector<float>> Rate_In;
+    std::vector<std::vector<float>> Rate_Out;
+    int Rate_InCount = 0;
+    int Rate_OutCount = 0;
+
 };
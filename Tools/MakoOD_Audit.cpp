@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    MakoOD_Audit.cpp
+    R1.01 Real time safety test. Runs the processor thru everything that can
+    change while audio is running (automation, Quality and Shaper switches,
+    host and MIDI program changes, state reloads, the editor taps, silence,
+    odd and oversized blocks, channel layouts, internal rate, offline) with
+    the audit hooks from MakoAudit.h in place. Any heap allocation or free,
+    lock or blocking system call inside processBlock is a violation and is
+    printed with its stack. It exits with 1 if there were any, so a build
+    server can use it as a test.
+
+    MakoOD_Audit [options]
+      --case <name>         Only run this case. Repeat as needed.
+      --seconds <n>         Audio seconds per case. Default 4.
+      --notes               Also show what prepareToPlay allocates and locks.
+      --list                Show the cases and exit.
+
+    Needs a build with MAKO_RTAUDIT=1 (the whole project, so processBlock
+    has its audit scope). See MakoOD_ToolUtils.h for how to build it.
+
+  ==============================================================================
+*/
+
+#define MAKO_AUDIT_HOOKS 1      //R1.01 This program gets the hooks. See MakoAudit.h.
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <cmath>
+#include "MakoOD_ToolUtils.h"
+
+#if ! MAKO_RTAUDIT
+ #error MakoOD_Audit needs a build with MAKO_RTAUDIT=1
+#endif
+
+const int e_Audit_Automate = 1;     //R1.01 New random values for every parameter each block.
+const int e_Audit_Quality = 2;      //R1.01 Step thru the Quality choices.
+const int e_Audit_Shaper = 4;       //R1.01 Step thru the Shaper choices.
+const int e_Audit_Programs = 8;     //R1.01 Host program changes and MIDI bank select + program change.
+const int e_Audit_State = 16;       //R1.01 Reload the plugin state now and then.
+const int e_Audit_Taps = 32;        //R1.01 Meter and analyzer feeds on, like an open editor.
+const int e_Audit_Silence = 64;     //R1.01 Audio and silence in turns, so the silence skip stops and starts.
+const int e_Audit_Blocks = 128;     //R1.01 Block sizes from 1 to 8x the prepared size.
+const int e_Audit_DualMono = 256;   //R1.01 Same samples on every channel.
+
+struct tp_audit_case {
+    const char* Name;
+    const char* About;
+    double Rate;
+    int Channels;
+    bool MonoIn;                //R1.01 Mono in, stereo out.
+    int Block;                  //R1.01 What prepareToPlay is told.
+    int Flags;                  //R1.01 e_Audit_ flags.
+    bool Reference = false;
+    float InternalRate = 0.0f;
+    bool Offline = false;
+};
+
+static const tp_audit_case Audit_Cases[] = {
+    { "steady",     "Stereo, default settings",                 48000.0,  2, false, 512,  0 },
+    { "automate",   "Every parameter automated every block",    48000.0,  2, false, 512,  e_Audit_Automate },
+    { "switch",     "Quality and Shaper switching",             48000.0,  2, false, 256,  e_Audit_Quality | e_Audit_Shaper | e_Audit_Automate },
+    { "programs",   "Host and MIDI program changes",            44100.0,  2, false, 512,  e_Audit_Programs },
+    { "state",      "State reloads while running",              48000.0,  2, false, 512,  e_Audit_State | e_Audit_Automate },
+    { "taps",       "Meter and analyzer feeds on",              48000.0,  2, false, 128,  e_Audit_Taps | e_Audit_Automate },
+    { "silence",    "Silence skip stopping and starting",       48000.0,  2, false, 512,  e_Audit_Silence | e_Audit_Taps },
+    { "blocks",     "Block sizes 1 to 8x the prepared size",    48000.0,  2, false, 512,  e_Audit_Blocks | e_Audit_Automate },
+    { "monoin",     "Mono in, stereo out",                      48000.0,  2, true,  512,  e_Audit_Automate | e_Audit_Taps },
+    { "dualmono",   "Stereo track carrying a mono signal",      48000.0,  2, false, 512,  e_Audit_DualMono | e_Audit_Silence },
+    { "surround",   "Six channels, all switching",              96000.0,  6, false, 1024, e_Audit_Automate | e_Audit_Quality | e_Audit_Shaper | e_Audit_Blocks },
+    { "internal",   "Internal rate mode at 192k",               192000.0, 2, false, 512,  e_Audit_Automate | e_Audit_Blocks | e_Audit_Quality, false, 48000.0f },
+    { "reference",  "Original per sample code",                 48000.0,  2, false, 512,  e_Audit_Automate | e_Audit_Programs | e_Audit_Blocks, true },
+    { "offline",    "Offline render (best quality)",            48000.0,  2, false, 2048, e_Audit_Automate | e_Audit_Shaper, false, 0.0f, true },
+};
+const int AUDIT_CASES = int(sizeof(Audit_Cases) / sizeof(Audit_Cases[0]));
+
+//R1.01 The parameters e_Audit_Automate moves. Quality and Shaper have their own flags.
+static const char* Audit_Automated[] = { "gain", "ngate", "low", "high", "drive", "enhlow", "enhhigh", "mix" };
+
+static juce::String Audit_Flags(int flags)
+{
+    const char* Names[] = { "automate", "quality", "shaper", "programs", "state", "taps", "silence", "blocks", "dualmono" };
+    juce::StringArray on;
+    for (int b = 0; b < 9; b++)
+        if (flags & (1 << b)) on.add(Names[b]);
+    return on.joinIntoString(",");
+}
+
+//R1.01 Guitar-ish test input. A plucked note every quarter second, or silence when Quiet.
+static void Audit_Fill(juce::AudioBuffer<float>& buffer, int channels, int num, juce::int64 pos, double rate, bool quiet, bool dualMono)
+{
+    for (int ch = 0; ch < channels; ch++)
+    {
+        float* data = buffer.getWritePointer(ch);
+        for (int t = 0; t < num; t++)
+        {
+            if (quiet) { data[t] = 0.0f; continue; }
+            double at = double(pos + t) / rate;
+            double np = std::fmod(at, .25);
+            double freq = 110.0 * ((dualMono || (ch == 0)) ? 1.0 : 1.5);
+            data[t] = float(.5 * std::exp(-np * 8.0) * std::sin(2.0 * 3.14159265358979 * freq * np));
+        }
+    }
+}
+
+//R1.01 Run one case. Returns the violations it caused.
+static int Audit_Run(const tp_audit_case& ac, double seconds)
+{
+    const int before = MakoAudit::Get().Violations();
+
+    MakoBiteAudioProcessor proc;
+    proc.Engine_UseScalarReference = ac.Reference;
+    proc.Engine_InternalRate = ac.InternalRate;
+    if (ac.MonoIn)
+    {
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(juce::AudioChannelSet::mono());
+        layout.outputBuses.add(juce::AudioChannelSet::stereo());
+        proc.setBusesLayout(layout);
+    }
+    else
+        MakoTool_SetChannels(proc, ac.Channels);
+
+    juce::StringArray params = { "ngate=.2", "drive=.6", "enhhigh=.4", "enhlow=.4", "mix=.8" };
+    juce::String error;
+    MakoTool_ApplySettings(proc, juce::File(), params, error);
+    juce::MemoryBlock state;
+    proc.getStateInformation(state);
+
+    proc.setNonRealtime(ac.Offline);
+    proc.setRateAndBufferSizeDetails(ac.Rate, ac.Block);
+    proc.prepareToPlay(ac.Rate, ac.Block);
+    proc.Meter_Active = (ac.Flags & e_Audit_Taps) != 0;
+    proc.Analyzer_Active = (ac.Flags & e_Audit_Taps) != 0;
+
+    //R1.01 Room for the biggest block this case sends. Everything the host side does happens outside processBlock.
+    const int maxBlock = (ac.Flags & e_Audit_Blocks) ? ac.Block * 8 : ac.Block;
+    juce::AudioBuffer<float> buffer(ac.Channels, maxBlock);
+    juce::MidiBuffer midi;
+    juce::uint8 Sysex[64] = { 0xf0, 0x7d };
+    for (int t = 2; t < 63; t++) Sysex[t] = juce::uint8(t);
+    Sysex[63] = 0xf7;
+    juce::Random rnd(25);
+    const int blockSizes[] = { 1, 7, ac.Block / 2, ac.Block, ac.Block + 1, ac.Block * 3, ac.Block * 8, 64 };
+    const juce::int64 total = juce::int64(ac.Rate * seconds);
+
+    int blockNo = 0;
+    for (juce::int64 pos = 0; pos < total; blockNo++)
+    {
+        const int num = (ac.Flags & e_Audit_Blocks) ? blockSizes[blockNo % 8] : ac.Block;
+        buffer.setSize(ac.Channels, num, false, false, true);
+        const bool quiet = (ac.Flags & e_Audit_Silence) && ((pos / juce::int64(ac.Rate)) % 2 == 1);
+        Audit_Fill(buffer, ac.MonoIn ? 1 : ac.Channels, num, pos, ac.Rate, quiet, (ac.Flags & e_Audit_DualMono) != 0);
+
+        if (ac.Flags & e_Audit_Automate)
+            for (const char* id : Audit_Automated) proc.parameters.getParameter(id)->setValueNotifyingHost(rnd.nextFloat());
+        if ((ac.Flags & e_Audit_Quality) && (blockNo % 16 == 0))
+            proc.parameters.getParameter("quality")->setValueNotifyingHost(float((blockNo / 16) % 4) / 3.0f);
+        if ((ac.Flags & e_Audit_Shaper) && (blockNo % 12 == 0))
+            proc.parameters.getParameter("shaper")->setValueNotifyingHost(float((blockNo / 12) % 3) / 2.0f);
+        if ((ac.Flags & e_Audit_State) && (blockNo % 20 == 0))
+            proc.setStateInformation(state.getData(), int(state.getSize()));
+
+        //R1.01 Every block also carries a long sysex, like a controller passing thru. processBlock must
+        //R1.01 skip over it without copying it (a juce::MidiMessage over 8 bytes allocates).
+        midi.clear();
+        midi.addEvent(Sysex, int(sizeof(Sysex)), 0);
+        if ((ac.Flags & e_Audit_Programs) && (blockNo % 10 == 0))
+        {
+            if (blockNo % 20 == 0)
+                proc.setCurrentProgram((blockNo / 20) % proc.getNumPrograms());
+            else
+            {
+                midi.addEvent(juce::MidiMessage::controllerEvent(1, 0, 0), 0);
+                midi.addEvent(juce::MidiMessage::controllerEvent(1, 32, 0), 0);
+                midi.addEvent(juce::MidiMessage::programChange(1, (blockNo / 10) % proc.getNumPrograms()), 1);
+            }
+        }
+
+        proc.processBlock(buffer, midi);
+        pos += num;
+    }
+
+    proc.releaseResources();
+    return MakoAudit::Get().Violations() - before;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+    MakoAudit::Get().Warm();
+
+    double seconds = 4.0;
+    bool notes = false;
+    juce::StringArray only;
+
+    for (int t = 1; t < argc; t++)
+    {
+        juce::String arg(argv[t]);
+        bool hasValue = (t + 1 < argc);
+        if (arg == "--case" && hasValue)            only.add(argv[++t]);
+        else if (arg == "--seconds" && hasValue)    seconds = juce::jmax(.25, juce::String(argv[++t]).getDoubleValue());
+        else if (arg == "--notes")                  notes = true;
+        else if (arg == "--list")
+        {
+            for (int c = 0; c < AUDIT_CASES; c++)
+                std::cout << juce::String(Audit_Cases[c].Name).paddedRight(' ', 12) << Audit_Cases[c].About << std::endl;
+            return 0;
+        }
+        else
+        {
+            std::cerr << "MakoOD_Audit [--case name ...] [--seconds n] [--notes] [--list]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "case        rate    ch  block  violations  flags" << std::endl;
+    MakoAudit::Get().Reset();
+    for (int c = 0; c < AUDIT_CASES; c++)
+    {
+        const tp_audit_case& ac = Audit_Cases[c];
+        if ((0 < only.size()) && (! only.contains(ac.Name))) continue;
+        int found = Audit_Run(ac, seconds);
+        std::cout << juce::String(ac.Name).paddedRight(' ', 12) << juce::String(juce::roundToInt(ac.Rate)).paddedRight(' ', 8)
+                  << juce::String(ac.Channels).paddedRight(' ', 4) << juce::String(ac.Block).paddedRight(' ', 7)
+                  << juce::String(found).paddedRight(' ', 12) << Audit_Flags(ac.Flags) << (found ? "  FAIL" : "") << std::endl;
+    }
+
+    std::cout << std::flush;
+    MakoAudit::Get().Report(stdout, ! notes);
+    std::fflush(stdout);
+    if (0 < MakoAudit::Get().Violations()) std::cout << "processBlock is not real time safe." << std::endl;
+    else std::cout << "No allocations, locks or blocking calls in processBlock." << std::endl;
+    return (0 < MakoAudit::Get().Violations()) ? 1 : 0;
+}
@@ -0,0 +1,465 @@
+/*
+  ==============================================================================
+
+    MakoOD_Bench.cpp
+    R1.01 Speed test for processBlock. Runs every mix of block size, sample
+    rate, channel count and optional stage (NGate, EnhHigh, EnhLow, Mix < 1)
+    and prints the cost of each as CSV or JSON. Keep the output from each
+    version so slow downs can be spotted and speed ups can be proven.
+
+    MakoOD_Bench [options]
+      --format <csv|json>   Output format. Default csv.
+      --out <file>          Write results to a file instead of the console.
+      --label <text>        Tag every row, e.g. a version or git hash.
+      --seconds <n>         Audio seconds per timed run. Default 1. Best of 3 runs is kept.
+      --blocks <list>       Block sizes. Default 16,32,64,128,256,512,1024,2048,4096
+      --rates <list>        Sample rates. Default 44100,48000,88200,96000,176400,192000
+      --channels <list>     Channel counts. Default 1,2
+      --quality <list>      Oversampling choices (0=1x .. 3=8x). Default 0
+      --engine <list>       simd, ref or both. Default simd
+      --set <id=value>      Set a parameter for every case (drive, gain, low, high, shaper).
+      --internal <rate>     Internal rate mode for every case, e.g. 48000. Default 0 (off).
+                            Use --label to tell these runs apart.
+      --profile <file>      Also write per stage timings (MakoProfile.h) for every case to file,
+                            in the same format. Needs a build with MAKO_PROFILE=1.
+      --quick               One block size (512) and one rate (48000).
+      --dual-mono           Same samples on every channel, like a mono DI on a stereo track.
+      --instances <list>    Many instance mode, e.g. 1,16,128,512. Runs that many processors
+                            round robin, one block each in turn like a DAW with that many
+                            tracks, all stages on. Shows what happens when the plugins no
+                            longer fit in the CPU caches. Replaces the normal stage sweep.
+
+    Columns: ns_per_sample is wall time per sample frame (all channels),
+    samples_per_sec is frames per second and realtime is how many times
+    faster than realtime that is at the case's sample rate.
+    In many instance mode ns_per_sample is per instance, realtime is for
+    all of them together and hot_bytes is one instance's per block DSP
+    state (MakoBiteAudioProcessor::Engine_HotBytes).
+    See MakoOD_ToolUtils.h for how to build it.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include "MakoOD_ToolUtils.h"
+
+//R1.01 One benchmark case and its result.
+struct tp_bench_case {
+    bool Reference = false;
+    int Quality = 0;
+    float InternalRate = 0.0f;
+    int Channels = 2;
+    double Rate = 48000.0;
+    int Block = 512;
+    int Stages = 0;             //R1.01 Bit mask of e_Bench_ flags.
+    double NsPerSample = 0.0;
+    double SamplesPerSec = 0.0;
+    double Realtime = 0.0;
+    int Instances = 0;          //R1.01 Many instance mode only.
+    int HotBytes = 0;
+    juce::StringArray Profile;  //R1.01 MakoProfiler rows, one per stage that ran (MAKO_PROFILE builds).
+};
+
+//R1.01 Optional stages, as bits in tp_bench_case::Stages.
+const int e_Bench_NGate = 1;
+const int e_Bench_EnhHigh = 2;
+const int e_Bench_EnhLow = 4;
+const int e_Bench_Mix = 8;
+const int e_Bench_AllStages = 16;
+
+static juce::Array<int> Bench_ParseList(const juce::String& text)
+{
+    juce::Array<int> list;
+    juce::String rest = text;
+    while (rest.isNotEmpty())
+    {
+        list.add(rest.upToFirstOccurrenceOf(",", false, false).trim().getIntValue());
+        rest = rest.fromFirstOccurrenceOf(",", false, false);
+    }
+    return list;
+}
+
+//R1.01 A guitar-ish test signal: a few decaying plucked notes over a little noise.
+//R1.01 Quiet gaps between notes let the noise gate open and close like real use.
+//R1.01 Each channel gets its own noise unless dualMono, then they are all copies of channel 0.
+static void Bench_MakeSignal(juce::AudioBuffer<float>& source, double rate, bool dualMono)
+{
+    juce::Random rnd(1234);
+    const int noteLen = int(rate * .25);
+    for (int ch = 0; ch < source.getNumChannels(); ch++)
+    {
+        float* data = source.getWritePointer(ch);
+        for (int t = 0; t < source.getNumSamples(); t++)
+        {
+            int note = t / noteLen;
+            double pos = double(t % noteLen) / rate;
+            double freq = 110.0 * std::pow(2.0, double((note * 5) % 24) / 12.0);
+            double env = std::exp(-pos * 12.0);
+            data[t] = float(.4 * env * (std::sin(2.0 * 3.14159265358979 * freq * pos) + .3 * std::sin(6.0 * 3.14159265358979 * freq * pos)))
+                    + (rnd.nextFloat() - .5f) * .002f;
+        }
+    }
+
+    if (dualMono)
+        for (int ch = 1; ch < source.getNumChannels(); ch++)
+            source.copyFrom(ch, 0, source, 0, 0, source.getNumSamples());
+}
+
+static void Bench_Run(tp_bench_case& bc, const juce::AudioBuffer<float>& source, const juce::StringArray& params, double seconds, bool json)
+{
+    MakoBiteAudioProcessor proc;
+    proc.Engine_UseScalarReference = bc.Reference;
+    proc.Engine_InternalRate = bc.InternalRate;
+    MakoTool_SetChannels(proc, bc.Channels);
+
+    juce::StringArray caseParams = params;
+    caseParams.add("ngate=" + juce::String((bc.Stages & e_Bench_NGate) ? .3 : 0.0, 2));
+    caseParams.add("enhhigh=" + juce::String((bc.Stages & e_Bench_EnhHigh) ? .5 : 0.0, 2));
+    caseParams.add("enhlow=" + juce::String((bc.Stages & e_Bench_EnhLow) ? .5 : 0.0, 2));
+    caseParams.add("mix=" + juce::String((bc.Stages & e_Bench_Mix) ? .5 : 1.0, 2));
+    caseParams.add("quality=" + juce::String(bc.Quality));
+    juce::String error;
+    MakoTool_ApplySettings(proc, juce::File(), caseParams, error);
+
+    proc.setNonRealtime(false);
+    proc.setRateAndBufferSizeDetails(bc.Rate, bc.Block);
+    proc.prepareToPlay(bc.Rate, bc.Block);
+
+    //R1.01 The source audio is reused in a loop. Each block is copied in fresh
+    //R1.01 so the gate and envelope always see the same signal. Only processBlock is timed.
+    juce::AudioBuffer<float> buffer(bc.Channels, bc.Block);
+    juce::MidiBuffer midi;
+    const int total = juce::jmax(bc.Block, int(bc.Rate * seconds));
+    const int blocks = (total + bc.Block - 1) / bc.Block;
+    int srcPos = 0;
+
+    auto runBlocks = [&](int count) -> double
+    {
+        double elapsed = 0.0;
+        for (int b = 0; b < count; b++)
+        {
+            if (source.getNumSamples() < srcPos + bc.Block) srcPos = 0;
+            for (int ch = 0; ch < bc.Channels; ch++)
+                buffer.copyFrom(ch, 0, source, ch, srcPos, bc.Block);
+            srcPos += bc.Block;
+
+            double start = juce::Time::getMillisecondCounterHiRes();
+            proc.processBlock(buffer, midi);
+            elapsed += juce::Time::getMillisecondCounterHiRes() - start;
+        }
+        return elapsed;
+    };
+
+    //R1.01 Warm up the caches and branch predictors, then keep the best of 3 runs.
+    runBlocks(juce::jmax(1, blocks / 4));
+#if MAKO_PROFILE
+    proc.Profile.Reset();
+#endif
+    double best = 1e30;
+    for (int run = 0; run < 3; run++)
+        best = juce::jmin(best, runBlocks(blocks));
+
+    double frames = double(blocks) * bc.Block;
+    bc.NsPerSample = (best * 1e6) / frames;
+    bc.SamplesPerSec = frames / (best / 1000.0);
+    bc.Realtime = bc.SamplesPerSec / bc.Rate;
+#if MAKO_PROFILE
+    for (int s = 0; s < MAKO_PROF_STAGES; s++)
+        if (0 < proc.Profile.Blocks(s)) bc.Profile.add(proc.Profile.Row(s, json));
+#else
+    juce::ignoreUnused(json);
+#endif
+    proc.releaseResources();
+}
+
+//R1.01 Many instance mode. Every instance gets its own buffer, like a track in a DAW, and they take
+//R1.01 turns one block at a time. Time is per round of all instances, so cache misses between them count.
+static void Bench_RunInstances(tp_bench_case& bc, const juce::AudioBuffer<float>& source, const juce::StringArray& params, double seconds)
+{
+    juce::StringArray caseParams = params;
+    caseParams.add("ngate=.3");
+    caseParams.add("enhhigh=.5");
+    caseParams.add("enhlow=.5");
+    caseParams.add("mix=.5");
+    caseParams.add("quality=" + juce::String(bc.Quality));
+
+    std::vector<std::unique_ptr<MakoBiteAudioProcessor>> procs;
+    std::vector<juce::AudioBuffer<float>> buffers;
+    for (int p = 0; p < bc.Instances; p++)
+    {
+        procs.push_back(std::make_unique<MakoBiteAudioProcessor>());
+        MakoBiteAudioProcessor& proc = *procs.back();
+        proc.Engine_UseScalarReference = bc.Reference;
+        proc.Engine_InternalRate = bc.InternalRate;
+        MakoTool_SetChannels(proc, bc.Channels);
+        juce::String error;
+        MakoTool_ApplySettings(proc, juce::File(), caseParams, error);
+        proc.setNonRealtime(false);
+        proc.setRateAndBufferSizeDetails(bc.Rate, bc.Block);
+        proc.prepareToPlay(bc.Rate, bc.Block);
+        buffers.emplace_back(bc.Channels, bc.Block);
+    }
+    bc.HotBytes = int(procs[0]->Engine_HotBytes());
+
+    //R1.01 Each instance starts at its own place in the source so they do not all gate at once.
+    juce::MidiBuffer midi;
+    const int rounds = juce::jmax(1, int(bc.Rate * seconds) / bc.Block);
+    const int srcLen = source.getNumSamples() - bc.Block;
+    int round = 0;
+
+    auto runRounds = [&](int count) -> double
+    {
+        double elapsed = 0.0;
+        for (int r = 0; r < count; r++, round++)
+        {
+            for (int p = 0; p < bc.Instances; p++)
+            {
+                int srcPos = int((juce::int64(round) * bc.Block + juce::int64(p) * 4099) % srcLen);
+                for (int ch = 0; ch < bc.Channels; ch++)
+                    buffers[size_t(p)].copyFrom(ch, 0, source, ch, srcPos, bc.Block);
+            }
+
+            double start = juce::Time::getMillisecondCounterHiRes();
+            for (int p = 0; p < bc.Instances; p++)
+                procs[size_t(p)]->processBlock(buffers[size_t(p)], midi);
+            elapsed += juce::Time::getMillisecondCounterHiRes() - start;
+        }
+        return elapsed;
+    };
+
+    runRounds(juce::jmax(1, rounds / 4));
+    double best = 1e30;
+    for (int run = 0; run < 3; run++)
+        best = juce::jmin(best, runRounds(rounds));
+
+    double frames = double(rounds) * bc.Block;
+    bc.NsPerSample = (best * 1e6) / (frames * bc.Instances);
+    bc.SamplesPerSec = frames / (best / 1000.0);
+    bc.Realtime = bc.SamplesPerSec / bc.Rate;
+    for (int p = 0; p < bc.Instances; p++) procs[size_t(p)]->releaseResources();
+}
+
+static juce::String Bench_InstanceRow(const tp_bench_case& bc, const juce::String& label, bool json)
+{
+    juce::String engine = bc.Reference ? "ref" : "simd";
+    if (json)
+        return "  {\"label\": \"" + label + "\", \"engine\": \"" + engine + "\", \"quality\": " + juce::String(bc.Quality)
+             + ", \"channels\": " + juce::String(bc.Channels) + ", \"rate\": " + juce::String(juce::roundToInt(bc.Rate)) + ", \"block\": " + juce::String(bc.Block)
+             + ", \"instances\": " + juce::String(bc.Instances) + ", \"ns_per_sample\": " + juce::String(bc.NsPerSample, 2)
+             + ", \"realtime\": " + juce::String(bc.Realtime, 1) + ", \"hot_bytes\": " + juce::String(bc.HotBytes) + "}";
+
+    return label + "," + engine + "," + juce::String(bc.Quality) + "," + juce::String(bc.Channels) + "," + juce::String(juce::roundToInt(bc.Rate))
+         + "," + juce::String(bc.Block) + "," + juce::String(bc.Instances) + "," + juce::String(bc.NsPerSample, 2) + "," + juce::String(bc.Realtime, 1)
+         + "," + juce::String(bc.HotBytes);
+}
+
+//R1.01 The columns that say which case a row is for. Shared by the timing and profile rows.
+static juce::String Bench_Case(const tp_bench_case& bc, const juce::String& label, bool json)
+{
+    juce::String engine = bc.Reference ? "ref" : "simd";
+    juce::String ngate = (bc.Stages & e_Bench_NGate) ? "1" : "0";
+    juce::String enhhigh = (bc.Stages & e_Bench_EnhHigh) ? "1" : "0";
+    juce::String enhlow = (bc.Stages & e_Bench_EnhLow) ? "1" : "0";
+    juce::String mix = (bc.Stages & e_Bench_Mix) ? "1" : "0";
+
+    if (json)
+        return "\"label\": \"" + label + "\", \"engine\": \"" + engine + "\", \"quality\": " + juce::String(bc.Quality)
+             + ", \"channels\": " + juce::String(bc.Channels) + ", \"rate\": " + juce::String(juce::roundToInt(bc.Rate)) + ", \"block\": " + juce::String(bc.Block)
+             + ", \"ngate\": " + ngate + ", \"enhhigh\": " + enhhigh + ", \"enhlow\": " + enhlow + ", \"mix\": " + mix;
+
+    return label + "," + engine + "," + juce::String(bc.Quality) + "," + juce::String(bc.Channels) + "," + juce::String(juce::roundToInt(bc.Rate)) + "," + juce::String(bc.Block)
+         + "," + ngate + "," + enhhigh + "," + enhlow + "," + mix;
+}
+
+static juce::String Bench_Row(const tp_bench_case& bc, const juce::String& label, bool json)
+{
+    if (json)
+        return "  {" + Bench_Case(bc, label, json)
+             + ", \"ns_per_sample\": " + juce::String(bc.NsPerSample, 2) + ", \"samples_per_sec\": " + juce::String(juce::int64(bc.SamplesPerSec))
+             + ", \"realtime\": " + juce::String(bc.Realtime, 1) + "}";
+
+    return Bench_Case(bc, label, json)
+         + "," + juce::String(bc.NsPerSample, 2) + "," + juce::String(juce::int64(bc.SamplesPerSec)) + "," + juce::String(bc.Realtime, 1);
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    juce::String format = "csv";
+    juce::String label;
+    juce::File outFile;
+    juce::File profFile;
+    double seconds = 1.0;
+    juce::Array<int> blockList = Bench_ParseList("16,32,64,128,256,512,1024,2048,4096");
+    juce::Array<int> rateList = Bench_ParseList("44100,48000,88200,96000,176400,192000");
+    juce::Array<int> chanList = Bench_ParseList("1,2");
+    juce::Array<int> qualList = Bench_ParseList("0");
+    juce::String engines = "simd";
+    juce::StringArray params;
+    float internalRate = 0.0f;
+    juce::Array<int> instList;
+    bool dualMono = false;
+
+    for (int t = 1; t < argc; t++)
+    {
+        juce::String arg(argv[t]);
+        bool hasValue = (t + 1 < argc);
+        if (arg == "--format" && hasValue)          format = juce::String(argv[++t]).toLowerCase();
+        else if (arg == "--out" && hasValue)        outFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--label" && hasValue)      label = argv[++t];
+        else if (arg == "--seconds" && hasValue)    seconds = juce::jmax(.01, juce::String(argv[++t]).getDoubleValue());
+        else if (arg == "--blocks" && hasValue)     blockList = Bench_ParseList(argv[++t]);
+        else if (arg == "--rates" && hasValue)      rateList = Bench_ParseList(argv[++t]);
+        else if (arg == "--channels" && hasValue)   chanList = Bench_ParseList(argv[++t]);
+        else if (arg == "--quality" && hasValue)    qualList = Bench_ParseList(argv[++t]);
+        else if (arg == "--engine" && hasValue)     engines = juce::String(argv[++t]).toLowerCase();
+        else if (arg == "--set" && hasValue)        params.add(argv[++t]);
+        else if (arg == "--internal" && hasValue)   internalRate = juce::jmax(0.0f, juce::String(argv[++t]).getFloatValue());
+        else if (arg == "--profile" && hasValue)    profFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--instances" && hasValue)  instList = Bench_ParseList(argv[++t]);
+        else if (arg == "--dual-mono")              dualMono = true;
+        else if (arg == "--quick")
+        {
+            blockList = Bench_ParseList("512");
+            rateList = Bench_ParseList("48000");
+        }
+        else
+        {
+            std::cerr << "MakoOD_Bench [--format csv|json] [--out file] [--label text] [--seconds n] [--blocks list]" << std::endl
+                      << "             [--rates list] [--channels list] [--quality list] [--engine simd|ref|both] [--set id=value]" << std::endl
+                      << "             [--internal rate] [--profile file] [--quick] [--instances list] [--dual-mono]" << std::endl;
+            return 1;
+        }
+    }
+
+    //R1.01 Catch bad --set values before the long run starts.
+    {
+        MakoBiteAudioProcessor proc;
+        juce::String error;
+        if (! MakoTool_ApplySettings(proc, juce::File(), params, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream fileStream;
+    if (outFile != juce::File())
+    {
+        fileStream.open(outFile.getFullPathName().toRawUTF8());
+        if (! fileStream)
+        {
+            std::cerr << "Can not write " << outFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = fileStream.is_open() ? fileStream : std::cout;
+    const bool json = (format == "json");
+
+    //R1.01 Per stage timings go to their own file, one row per stage per case.
+    std::ofstream profStream;
+    if (profFile != juce::File())
+    {
+#if MAKO_PROFILE
+        profStream.open(profFile.getFullPathName().toRawUTF8());
+        if (! profStream)
+        {
+            std::cerr << "Can not write " << profFile.getFullPathName() << std::endl;
+            return 1;
+        }
+        if (json) profStream << "[" << std::endl;
+        else profStream << "label,engine,quality,channels,rate,block,ngate,enhhigh,enhlow,mix," << MakoProfiler::RowHeader() << std::endl;
+#else
+        std::cerr << "--profile needs a build with MAKO_PROFILE=1" << std::endl;
+        return 1;
+#endif
+    }
+    bool profFirst = true;
+
+    if (json) out << "[" << std::endl;
+    else if (0 < instList.size()) out << "label,engine,quality,channels,rate,block,instances,ns_per_sample,realtime,hot_bytes" << std::endl;
+    else out << "label,engine,quality,channels,rate,block,ngate,enhhigh,enhlow,mix,ns_per_sample,samples_per_sec,realtime" << std::endl;
+
+    bool first = true;
+    for (int e = 0; e < 2; e++)
+    {
+        bool reference = (e == 1);
+        if ((engines != "both") && (engines != (reference ? "ref" : "simd"))) continue;
+
+        for (int q = 0; q < qualList.size(); q++)
+        for (int c = 0; c < chanList.size(); c++)
+        for (int r = 0; r < rateList.size(); r++)
+        {
+            //R1.01 Two seconds of test audio, made once for all the cases at this rate.
+            juce::AudioBuffer<float> source(chanList[c], rateList[r] * 2);
+            Bench_MakeSignal(source, double(rateList[r]), dualMono);
+
+            //R1.01 Many instance mode. The source is longer so each instance can start somewhere else.
+            if (0 < instList.size())
+            {
+                juce::AudioBuffer<float> longSource(chanList[c], rateList[r] * 8);
+                Bench_MakeSignal(longSource, double(rateList[r]), dualMono);
+                for (int b = 0; b < blockList.size(); b++)
+                for (int n = 0; n < instList.size(); n++)
+                {
+                    tp_bench_case bc;
+                    bc.Reference = reference;
+                    bc.Quality = qualList[q];
+                    bc.InternalRate = internalRate;
+                    bc.Channels = chanList[c];
+                    bc.Rate = double(rateList[r]);
+                    bc.Block = juce::jmax(1, blockList[b]);
+                    bc.Instances = juce::jmax(1, instList[n]);
+                    Bench_RunInstances(bc, longSource, params, seconds);
+
+                    if (json && ! first) out << "," << std::endl;
+                    out << Bench_InstanceRow(bc, label, json);
+                    if (! json) out << std::endl;
+                    out.flush();
+                    first = false;
+                }
+                continue;
+            }
+
+            for (int b = 0; b < blockList.size(); b++)
+            for (int s = 0; s < e_Bench_AllStages; s++)
+            {
+                tp_bench_case bc;
+                bc.Reference = reference;
+                bc.Quality = qualList[q];
+                bc.InternalRate = internalRate;
+                bc.Channels = chanList[c];
+                bc.Rate = double(rateList[r]);
+                bc.Block = juce::jmax(1, blockList[b]);
+                bc.Stages = s;
+                Bench_Run(bc, source, params, seconds, json);
+
+                if (json && ! first) out << "," << std::endl;
+                out << Bench_Row(bc, label, json);
+                if (! json) out << std::endl;
+                out.flush();
+                first = false;
+
+                if (profStream.is_open())
+                {
+                    for (int p = 0; p < bc.Profile.size(); p++)
+                    {
+                        if (json && ! profFirst) profStream << "," << std::endl;
+                        if (json) profStream << "  {" << Bench_Case(bc, label, json) << ", " << bc.Profile[p] << "}";
+                        else profStream << Bench_Case(bc, label, json) << "," << bc.Profile[p] << std::endl;
+                        profFirst = false;
+                    }
+                    profStream.flush();
+                }
+            }
+        }
+    }
+
+    if (json) out << std::endl << "]" << std::endl;
+    if (json && profStream.is_open()) profStream << std::endl << "]" << std::endl;
+    return 0;
+}
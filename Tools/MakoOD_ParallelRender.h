@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    MakoOD_ParallelRender.h
+    R1.01 Render one long buffer on every CPU core.
+
+    The buffer is cut into chunks and each chunk gets its own processor.
+    The only things MakoOD remembers from sample to sample are filter
+    histories, the noise gate level and the oversampler. All of them
+    forget the past quickly, so each chunk first runs a short piece of
+    the audio before it (the pre-roll) and throws that output away.
+    After that its state matches a straight start-to-end render.
+
+    After about .02 s the states only differ by float rounding. The gain
+    stages amplify that, so the output is not bit exact while a note is
+    still sounding. Max difference from a serial render, 48 kHz, 8x,
+    20 s of plucked notes, 1.7 s chunks:
+      Drive 0, no Enh:                            1e-7  (-140 dB)
+      NGate .3, Drive .7, Enh .5/.5, Mix .8:      5e-4  (-66 dB)
+      No pre-roll:                                2.0   (clicks at every chunk edge)
+    More pre-roll does not lower the rounding part. A chunk whose pre-roll
+    reaches back into silence matches the serial render exactly.
+    The default .1 s pre-roll adds 1% work per 10 s chunk.
+    Settings can not change during the render (no automation).
+    Chunks and pre-roll start on a multiple of MAKO_RENDER_ALIGN samples, so
+    the internal rate mode cuts the audio into the same resampler groups
+    as a serial render.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <thread>
+#include <atomic>
+#include "MakoOD_ToolUtils.h"
+
+const int MAKO_RENDER_ALIGN = 1 << MAKO_OS_MAXSTAGES;  //R1.01 The biggest internal rate factor (8x).
+
+struct tp_parallel_render {
+    int Threads = 0;                //R1.01 0 = one per CPU.
+    double ChunkSeconds = 10.0;     //R1.01 Audio per chunk. Pre-roll is extra work per chunk, so keep this much bigger.
+    double PrerollSeconds = .1;     //R1.01 Warm up before each chunk. 0 gives a plain chunked render (clicks).
+    int BlockSize = 512;            //R1.01 Block size passed to processBlock.
+    float InternalRate = 0.0f;      //R1.01 See MakoBiteAudioProcessor::Engine_InternalRate.
+};
+
+//R1.01 Render input[first, last) into the same spot in output, warming up on preroll samples before first.
+//R1.01 The plugin latency is removed, so output lines up with input just like the render tool.
+inline void MakoTool_RenderChunk(MakoBiteAudioProcessor& proc, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                 double sampleRate, int blockSize, int first, int last, int preroll)
+{
+    const int numChannels = input.getNumChannels();
+    const int length = input.getNumSamples();
+
+    //R1.01 prepareToPlay clears every filter, so each chunk starts from silence like a new render.
+    proc.prepareToPlay(sampleRate, blockSize);
+    const int latency = proc.getLatencySamples();
+
+    //R1.01 Feed from (first - preroll) to (last + latency). Past the end of the input we feed silence.
+    //R1.01 Start on a whole resampler group, like a serial render from 0 does.
+    const int feedStart = juce::jmax(0, first - preroll) / MAKO_RENDER_ALIGN * MAKO_RENDER_ALIGN;
+    const int feedEnd = last + latency;
+    const int keepFrom = first + latency;       //R1.01 Feed position whose output is input sample "first".
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+    for (int pos = feedStart; pos < feedEnd; pos += blockSize)
+    {
+        const int num = juce::jmin(blockSize, feedEnd - pos);
+        const int avail = juce::jlimit(0, num, length - pos);
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, num);
+        block.clear();
+        for (int ch = 0; ch < numChannels; ch++)
+            if (0 < avail) block.copyFrom(ch, 0, input, ch, pos, avail);
+
+        proc.processBlock(block, midi);
+
+        //R1.01 Keep only the part of this block that lands inside [first, last).
+        const int keepStart = juce::jmax(pos, keepFrom);
+        const int keepEnd = pos + num;
+        if (keepStart < keepEnd)
+            for (int ch = 0; ch < numChannels; ch++)
+                output.copyFrom(ch, keepStart - latency, block, ch, keepStart - pos, keepEnd - keepStart);
+    }
+    proc.releaseResources();
+}
+
+//R1.01 Render the whole input with the given plugin state (from getStateInformation) using every core.
+//R1.01 output is resized to match input. Returns false and sets error if the channel layout is not supported.
+inline bool MakoTool_RenderParallel(const juce::MemoryBlock& state, const juce::AudioBuffer<float>& input, juce::AudioBuffer<float>& output,
+                                    double sampleRate, const tp_parallel_render& opts, juce::String& error)
+{
+    const int length = input.getNumSamples();
+    const int chunkLen = juce::jmax(MAKO_RENDER_ALIGN, juce::jmax(opts.BlockSize, int(opts.ChunkSeconds * sampleRate)) / MAKO_RENDER_ALIGN * MAKO_RENDER_ALIGN);
+    const int preroll = juce::jmax(0, int(opts.PrerollSeconds * sampleRate));
+    const int numChunks = juce::jmax(1, (length + chunkLen - 1) / chunkLen);
+    int numThreads = (0 < opts.Threads) ? opts.Threads : juce::SystemStats::getNumCpus();
+    numThreads = juce::jlimit(1, numChunks, numThreads);
+
+    output.setSize(input.getNumChannels(), length);
+    std::atomic<int> nextChunk { 0 };
+    std::atomic<bool> failed { false };
+    std::vector<std::thread> workers;
+
+    for (int w = 0; w < numThreads; w++)
+    {
+        workers.emplace_back([&]()
+        {
+            MakoBiteAudioProcessor proc;
+            if (! MakoTool_SetChannels(proc, input.getNumChannels()))
+            {
+                failed = true;
+                return;
+            }
+            proc.setStateInformation(state.getData(), int(state.getSize()));
+            proc.Engine_InternalRate = opts.InternalRate;
+            proc.setNonRealtime(true);
+            proc.setRateAndBufferSizeDetails(sampleRate, opts.BlockSize);
+
+            //R1.01 Chunks write to different parts of output, so no locking is needed.
+            for (int idx = nextChunk++; idx < numChunks; idx = nextChunk++)
+            {
+                int first = idx * chunkLen;
+                int last = juce::jmin(length, first + chunkLen);
+                MakoTool_RenderChunk(proc, input, output, sampleRate, opts.BlockSize, first, last, preroll);
+            }
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+
+    if (failed)
+    {
+        error = "Unsupported channel count (" + juce::String(input.getNumChannels()) + ")";
+        return false;
+    }
+    return true;
+}
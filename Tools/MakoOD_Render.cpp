@@ -0,0 +1,308 @@
+/*
+  ==============================================================================
+
+    MakoOD_Render.cpp
+    R1.01 Offline render tool. Runs the MakoOD processor over audio files
+    without a DAW, spreading the files over several worker threads.
+    Each worker owns one processor and reuses it for every file it takes.
+
+    MakoOD_Render [options] file1.wav [file2.flac ...]
+      --out <folder>       Where to write results. Default: next to each input.
+      --preset <file>      Parameter XML (see --save-preset).
+      --set <id=value>     Set one parameter. Repeat as needed.
+                           gain, ngate, low, high, drive, enhlow, enhhigh, mix, quality, shaper
+      --block <n>          Block size passed to processBlock. Default 512.
+      --threads <n>        Worker threads. Default: one per CPU.
+      --format <wav|flac>  Output format. Default: same as the input.
+      --bits <n>           Output bit depth. Default 24.
+      --save-preset <file> Write the final settings as a preset and exit.
+      --internal <rate>    Internal rate mode, e.g. 48000. Files at 2x, 4x or 8x that
+                           rate run the OD at that rate. Default 0 (off).
+      --chunk <seconds>    Render one file at a time, split into chunks of this
+                           length that run on all threads. For long files.
+                           See MakoOD_ParallelRender.h for the accuracy.
+
+    Output files are named <input name>_makood.<ext>. The plugin's latency
+    (oversampling) is removed so the result lines up with the input.
+    See MakoOD_ToolUtils.h for how to build it.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include "MakoOD_ToolUtils.h"
+#include "MakoOD_ParallelRender.h"
+
+//R1.01 Everything one render run needs to know.
+struct tp_render_job {
+    juce::Array<juce::File> Inputs;
+    juce::File OutDir;
+    juce::File PresetFile;
+    juce::StringArray Params;
+    juce::String Format;
+    int BlockSize = 512;
+    int Bits = 24;
+    double ChunkSeconds = 0.0;      //R1.01 0 = whole files per thread, otherwise split each file.
+    float InternalRate = 0.0f;      //R1.01 See MakoBiteAudioProcessor::Engine_InternalRate.
+};
+
+static void Render_Usage()
+{
+    std::cout << "MakoOD_Render [--out dir] [--preset file] [--set id=value ...] [--block n]" << std::endl
+              << "              [--threads n] [--format wav|flac] [--bits n] [--save-preset file] [--chunk seconds]" << std::endl
+              << "              [--internal rate] files..." << std::endl;
+}
+
+//R1.01 Create the writer for input's result file. Returns nullptr and sets msg on failure.
+static std::unique_ptr<juce::AudioFormatWriter> Render_OpenWriter(juce::AudioFormatManager& formats, const tp_render_job& job, const juce::File& input,
+                                                                  double sampleRate, int numChannels, juce::File& output, juce::String& msg)
+{
+    //R1.01 Output format. Keep the input's unless asked otherwise.
+    juce::String ext = job.Format.isNotEmpty() ? job.Format : input.getFileExtension().substring(1).toLowerCase();
+    juce::AudioFormat* outFormat = formats.findFormatForFileExtension(ext);
+    if (outFormat == nullptr)
+    {
+        msg = "Unknown output format: " + ext;
+        return nullptr;
+    }
+    juce::File outDir = (job.OutDir != juce::File()) ? job.OutDir : input.getParentDirectory();
+    output = outDir.getChildFile(input.getFileNameWithoutExtension() + "_makood." + ext);
+    output.deleteFile();
+    std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+    if (stream == nullptr)
+    {
+        msg = "Can not write " + output.getFullPathName();
+        return nullptr;
+    }
+    std::unique_ptr<juce::AudioFormatWriter> writer(outFormat->createWriterFor(stream.get(), sampleRate, (unsigned int)numChannels, job.Bits, {}, 0));
+    if (writer == nullptr)
+    {
+        msg = "Can not create a " + ext + " writer for " + output.getFileName();
+        return nullptr;
+    }
+    stream.release();   //R1.01 The writer owns the stream now.
+    return writer;
+}
+
+//R1.01 Report line shared by both render modes.
+static juce::String Render_Report(const juce::File& input, const juce::File& output, juce::int64 length, double sampleRate, double startTime)
+{
+    double secs = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+    double audioSecs = double(length) / sampleRate;
+    return input.getFileName() + " -> " + output.getFileName() + "  (" + juce::String(audioSecs, 1) + " s audio in "
+         + juce::String(secs, 2) + " s, " + juce::String(audioSecs / juce::jmax(secs, .001), 1) + "x realtime)";
+}
+
+static bool Render_File(MakoBiteAudioProcessor& proc, juce::AudioFormatManager& formats, const tp_render_job& job, const juce::File& input, juce::String& msg)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+    if (reader == nullptr)
+    {
+        msg = "Can not read " + input.getFullPathName();
+        return false;
+    }
+
+    const int numChannels = int(reader->numChannels);
+    const double sampleRate = reader->sampleRate;
+    if (! MakoTool_SetChannels(proc, numChannels))
+    {
+        msg = "Unsupported channel count (" + juce::String(numChannels) + ") in " + input.getFileName();
+        return false;
+    }
+
+    juce::File output;
+    std::unique_ptr<juce::AudioFormatWriter> writer = Render_OpenWriter(formats, job, input, sampleRate, numChannels, output, msg);
+    if (writer == nullptr) return false;
+
+    //R1.01 Same order a host uses. Non realtime lets the processor pick its render quality.
+    proc.Engine_InternalRate = job.InternalRate;
+    proc.setNonRealtime(true);
+    proc.setRateAndBufferSizeDetails(sampleRate, job.BlockSize);
+    proc.prepareToPlay(sampleRate, job.BlockSize);
+    const int latency = proc.getLatencySamples();
+
+    //R1.01 Stream the file thru in blocks. Extra silent blocks at the end flush out the latency.
+    juce::AudioBuffer<float> buffer(numChannels, job.BlockSize);
+    juce::MidiBuffer midi;
+    const juce::int64 length = reader->lengthInSamples;
+    juce::int64 readPos = 0;
+    juce::int64 toSkip = latency;
+    juce::int64 toWrite = length;
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    while (0 < toWrite)
+    {
+        int num = job.BlockSize;
+        buffer.clear();
+        if (readPos < length)
+            reader->read(&buffer, 0, int(juce::jmin(juce::int64(num), length - readPos)), readPos, true, true);
+        readPos += num;
+
+        proc.processBlock(buffer, midi);
+
+        //R1.01 Drop the first "latency" samples so the output lines up with the input.
+        int offset = int(juce::jmin(juce::int64(num), toSkip));
+        toSkip -= offset;
+        int count = int(juce::jmin(juce::int64(num - offset), toWrite));
+        if (0 < count)
+        {
+            writer->writeFromAudioSampleBuffer(buffer, offset, count);
+            toWrite -= count;
+        }
+    }
+
+    proc.releaseResources();
+
+    msg = Render_Report(input, output, length, sampleRate, startTime);
+    return true;
+}
+
+//R1.01 --chunk mode. Load the whole file and let MakoTool_RenderParallel spread its chunks over the threads.
+static bool Render_FileSplit(const juce::MemoryBlock& state, juce::AudioFormatManager& formats, const tp_render_job& job, const juce::File& input, int numThreads, juce::String& msg)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(input));
+    if ((reader == nullptr) || (std::numeric_limits<int>::max() < reader->lengthInSamples))
+    {
+        msg = "Can not read " + input.getFullPathName();
+        return false;
+    }
+
+    const int numChannels = int(reader->numChannels);
+    const double sampleRate = reader->sampleRate;
+    const int length = int(reader->lengthInSamples);
+    juce::File output;
+    std::unique_ptr<juce::AudioFormatWriter> writer = Render_OpenWriter(formats, job, input, sampleRate, numChannels, output, msg);
+    if (writer == nullptr) return false;
+
+    juce::AudioBuffer<float> source(numChannels, length);
+    reader->read(&source, 0, length, 0, true, true);
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+    tp_parallel_render opts;
+    opts.Threads = numThreads;
+    opts.ChunkSeconds = job.ChunkSeconds;
+    opts.BlockSize = job.BlockSize;
+    opts.InternalRate = job.InternalRate;
+    juce::AudioBuffer<float> result;
+    juce::String error;
+    if (! MakoTool_RenderParallel(state, source, result, sampleRate, opts, error))
+    {
+        msg = error + " in " + input.getFileName();
+        return false;
+    }
+    writer->writeFromAudioSampleBuffer(result, 0, length);
+
+    msg = Render_Report(input, output, length, sampleRate, startTime);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    //R1.01 The processor's parameters need JUCE's message system to exist.
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    tp_render_job job;
+    juce::File savePreset;
+    int numThreads = juce::SystemStats::getNumCpus();
+
+    for (int t = 1; t < argc; t++)
+    {
+        juce::String arg(argv[t]);
+        bool hasValue = (t + 1 < argc);
+        if (arg == "--out" && hasValue)              job.OutDir = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--preset" && hasValue)      job.PresetFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--set" && hasValue)         job.Params.add(argv[++t]);
+        else if (arg == "--block" && hasValue)       job.BlockSize = juce::jlimit(1, 65536, juce::String(argv[++t]).getIntValue());
+        else if (arg == "--threads" && hasValue)     numThreads = juce::jmax(1, juce::String(argv[++t]).getIntValue());
+        else if (arg == "--format" && hasValue)      job.Format = juce::String(argv[++t]).toLowerCase();
+        else if (arg == "--bits" && hasValue)        job.Bits = juce::String(argv[++t]).getIntValue();
+        else if (arg == "--save-preset" && hasValue) savePreset = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--internal" && hasValue)    job.InternalRate = juce::jmax(0.0f, juce::String(argv[++t]).getFloatValue());
+        else if (arg == "--chunk" && hasValue)       job.ChunkSeconds = juce::jmax(0.0, juce::String(argv[++t]).getDoubleValue());
+        else if (arg.startsWith("--"))
+        {
+            Render_Usage();
+            return 1;
+        }
+        else
+            job.Inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+    }
+
+    //R1.01 Check the settings once up front so a bad --set fails before any work starts.
+    juce::MemoryBlock state;
+    {
+        MakoBiteAudioProcessor proc;
+        juce::String error;
+        if (! MakoTool_ApplySettings(proc, job.PresetFile, job.Params, error))
+        {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        if (savePreset != juce::File())
+            return MakoTool_SavePreset(proc, savePreset) ? 0 : 1;
+        proc.getStateInformation(state);
+    }
+
+    if (job.Inputs.isEmpty())
+    {
+        Render_Usage();
+        return 1;
+    }
+    if (job.OutDir != juce::File()) job.OutDir.createDirectory();
+
+    //R1.01 Chunk mode: one file at a time, every thread works on that file.
+    if (0.0 < job.ChunkSeconds)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        int failed = 0;
+        for (int idx = 0; idx < job.Inputs.size(); idx++)
+        {
+            juce::String msg;
+            bool ok = Render_FileSplit(state, formats, job, job.Inputs[idx], numThreads, msg);
+            if (! ok) failed++;
+            (ok ? std::cout : std::cerr) << msg << std::endl;
+        }
+        return (failed == 0) ? 0 : 2;
+    }
+
+    //R1.01 Workers pull the next file off a shared counter until there are none left.
+    numThreads = juce::jmin(numThreads, job.Inputs.size());
+    std::atomic<int> nextFile { 0 };
+    std::atomic<int> failed { 0 };
+    juce::CriticalSection printLock;
+    std::vector<std::thread> workers;
+
+    for (int w = 0; w < numThreads; w++)
+    {
+        workers.emplace_back([&job, &nextFile, &failed, &printLock]()
+        {
+            juce::AudioFormatManager formats;
+            formats.registerBasicFormats();
+            MakoBiteAudioProcessor proc;
+            juce::String msg;
+            if (! MakoTool_ApplySettings(proc, job.PresetFile, job.Params, msg))
+            {
+                failed++;
+                return;
+            }
+
+            for (int idx = nextFile++; idx < job.Inputs.size(); idx = nextFile++)
+            {
+                bool ok = Render_File(proc, formats, job, job.Inputs[idx], msg);
+                if (! ok) failed++;
+
+                const juce::ScopedLock sl(printLock);
+                (ok ? std::cout : std::cerr) << msg << std::endl;
+            }
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+
+    return (failed == 0) ? 0 : 2;
+}
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    MakoOD_ToolUtils.h
+    R1.01 Helpers shared by the command line tools in this folder.
+
+    The tools build the plugin's processor directly, no host needed. To
+    build one, make a Projucer "Console Application" project and add:
+      - the tool's .cpp file from this folder
+      - ../PluginProcessor.cpp/.h, ../PluginEditor.cpp/.h and the other
+        headers from the plugin folder
+      - the background image (images/makoodback01.jpg) as a binary resource
+      - the same JUCE modules as the plugin
+      - preprocessor definition: JucePlugin_Name="MakoOD"
+      - MakoOD_Audit also needs MAKO_RTAUDIT=1 (see ../MakoAudit.h)
+    The Linux Makefile exporter builds them for build servers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../PluginProcessor.h"
+
+//R1.01 Set the processor's channel layout. Input and output always match.
+inline bool MakoTool_SetChannels(MakoBiteAudioProcessor& proc, int numChannels)
+{
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    layout.outputBuses.add(juce::AudioChannelSet::canonicalChannelSet(numChannels));
+    return proc.setBusesLayout(layout);
+}
+
+//R1.01 Apply a preset file (parameter XML saved by the plugin or by --save-preset)
+//R1.01 and then any "id=value" overrides. Choice parameters (quality, shaper) take their index.
+//R1.01 A value outside the parameter's range is an error, not clamped, so a typo can not quietly test something else.
+inline bool MakoTool_ApplySettings(MakoBiteAudioProcessor& proc, const juce::File& presetFile, const juce::StringArray& params, juce::String& error)
+{
+    if (presetFile != juce::File())
+    {
+        std::unique_ptr<juce::XmlElement> xml = juce::XmlDocument::parse(presetFile);
+        if ((xml == nullptr) || (! xml->hasTagName(proc.parameters.state.getType())))
+        {
+            error = "Not a MakoOD preset: " + presetFile.getFullPathName();
+            return false;
+        }
+        proc.parameters.replaceState(juce::ValueTree::fromXml(*xml));
+    }
+
+    for (int t = 0; t < params.size(); t++)
+    {
+        juce::String id = params[t].upToFirstOccurrenceOf("=", false, false).trim();
+        juce::String val = params[t].fromFirstOccurrenceOf("=", false, false).trim();
+        juce::RangedAudioParameter* parm = proc.parameters.getParameter(id);
+        if ((parm == nullptr) || val.isEmpty())
+        {
+            error = "Unknown parameter setting: " + params[t];
+            return false;
+        }
+        const juce::NormalisableRange<float>& range = parm->getNormalisableRange();
+        const float v = val.getFloatValue();
+        if ((! std::isfinite(v)) || (v < range.start) || (range.end < v))
+        {
+            error = "Setting out of range (" + juce::String(range.start) + " to " + juce::String(range.end) + "): " + params[t];
+            return false;
+        }
+        parm->setValueNotifyingHost(parm->convertTo0to1(v));
+    }
+
+    //R1.01 Round trip thru the plugin state so the processor reloads every setting.
+    juce::MemoryBlock state;
+    proc.getStateInformation(state);
+    proc.setStateInformation(state.getData(), int(state.getSize()));
+    return true;
+}
+
+//R1.01 Save the current parameters as a preset file the tools can load.
+inline bool MakoTool_SavePreset(MakoBiteAudioProcessor& proc, const juce::File& presetFile)
+{
+    std::unique_ptr<juce::XmlElement> xml(proc.parameters.copyState().createXml());
+    return (xml != nullptr) && xml->writeTo(presetFile);
+}
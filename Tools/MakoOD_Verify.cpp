@@ -0,0 +1,612 @@
+/*
+  ==============================================================================
+
+    MakoOD_Verify.cpp
+    R1.01 Golden reference check. Runs fixed test signals thru the original
+    per sample code (Engine_UseScalarReference) and thru every fast or
+    alternative path, then compares each against the reference.
+    Run it after any change to the DSP code. It exits with 1 if any path
+    is outside its tolerance, so a build server can use it as a test.
+
+    MakoOD_Verify [options]
+      --rate <hz>           Sample rate. Default 48000.
+      --seconds <n>         Length of each test signal. Default 2.
+      --path <name>         Only run this path. Repeat as needed.
+      --csv <file>          Also write every result row to a CSV file.
+      --golden <dir>        Also check each sound changing path against its own
+                            render in dir, saved earlier by --write-golden.
+      --write-golden <dir>  Save those renders to dir (from a known good build).
+      --list                Show the paths and their tolerances and exit.
+
+    Signals: log sine sweep, impulses, white noise and plucked DI-like notes.
+    Stereo, with the right channel different from the left so a lane mix up
+    shows. Each one runs with three settings (default, every stage on, hot).
+
+    Columns:
+      peak_db   Largest sample error, dB relative to the reference peak.
+      rms_db    RMS error, dB relative to the reference RMS.
+      band_db   Error spectrum under 5 kHz, dB relative to the reference
+                under 5 kHz. For ADAA paths the reference is delayed first,
+                by however much (up to MaxDelay) gives the least error.
+      delay     That delay, in samples.
+      spec_db   Worst octave band (31 Hz to 16 kHz) of the error spectrum,
+                dB relative to the reference in the same band.
+    Each path is compared with the reference or, for paths that should
+    give identical output (block size, mono), with the path they split up.
+    A path passes when rms_db is at or below its tolerance. Bit exact
+    paths must match every sample. Paths that change the sound on purpose
+    (oversampling, internal rate, ADAA) mostly change the top octaves, so
+    their tolerance is on band_db instead (shown as "band"). What is left
+    of their error is mostly the reference's own aliasing, so with
+    --golden they are also held to VERIFY_GOLDEN against a stored render
+    of the same path (rows against "golden"), which catches a regression
+    the band check is too loose to see.
+    In a MAKO_RTAUDIT=1 build any allocation, lock or blocking call inside
+    processBlock also fails the run (MakoAudit.h, MakoOD_Audit.cpp).
+    See MakoOD_ToolUtils.h for how to build it.
+
+  ==============================================================================
+*/
+
+#define MAKO_AUDIT_HOOKS 1      //R1.01 Audit builds only. See MakoAudit.h.
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <fstream>
+#include <complex>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "MakoOD_ToolUtils.h"
+
+const float VERIFY_BITEXACT = -1000.0f;     //R1.01 Tolerance: every sample must match.
+const int VERIFY_FFT = 4096;                //R1.01 Spectrum frame size. Hann window, 50% overlap.
+const double VERIFY_INBAND = 5000.0;        //R1.01 Upper edge of the in band error (band_db).
+const double VERIFY_DELAYSTEP = .01;        //R1.01 Delay search step, samples.
+const float VERIFY_GOLDEN = -80.0f;         //R1.01 Tolerance against a stored render of the same path.
+
+//R1.01 One way of running the processor, and what it is checked against.
+struct tp_verify_path {
+    const char* Name;
+    const char* About;
+    const char* Against;        //R1.01 Name of an earlier path. nullptr for the reference itself.
+    float TolDb;
+    bool Reference;
+    int Tanh;
+    int Block;
+    int Quality;
+    float InternalRate;         //R1.01 Below 0 is a fraction of the test rate.
+    bool Mono;                  //R1.01 Run each channel on its own mono instance.
+    int Shaper = MAKO_ADAA_OFF; //R1.01 The shaper parameter (MAKO_ADAA_).
+    bool InBand = false;        //R1.01 TolDb is on band_db, not rms_db.
+    float MaxDelay = 0.0f;      //R1.01 Largest delay band_db may take out of the path, samples.
+};
+
+//R1.01 Tolerances are on the RMS error, a few dB above what each path measured when it was added.
+//R1.01 The drive stages turn float rounding into errors near -90 dB (peaks near -50 dB on hot
+//R1.01 settings), so a different but correct order of float math can not do much better than -80.
+//R1.01 Paths that should only differ in how the work is split up are checked against the block
+//R1.01 engine. Block size only moves the point where a dying tail drops into the -180 dB silence
+//R1.01 skip (Silence_Level), so those get -150 dB instead of bit exact.
+//R1.01 Oversampling, internal rate and ADAA are meant to sound different above 5 kHz (less aliasing),
+//R1.01 so they are checked under 5 kHz only. Each ADAA shaper delays what it adds by half a sample
+//R1.01 (1st order) or one sample (2nd order), three shapers in a row, so band_db takes the best delay up
+//R1.01 to MaxDelay out first. What is left under 5 kHz is the reference's own aliasing folding down,
+//R1.01 worst on the hot noise runs, so these can not get much tighter against the reference. The stored
+//R1.01 renders (--golden) are the tight check for these paths. Their block size and mono
+//R1.01 paths are checked against them like the block engine's. A mono instance decides on its own when
+//R1.01 its side has rung out, and a stereo one joins its sides back up once they are within -180 dB
+//R1.01 (Mono_Resync), so the mono paths get -150 dB too.
+//R1.01 Tighten these if a change makes a path more accurate, never loosen them just to make a test pass.
+static const tp_verify_path Verify_Paths[] = {
+    { "ref",        "Original per sample code, C library tanhf",   nullptr,    VERIFY_BITEXACT, true,  MAKO_TANH_EXACT,     512,  0, 0.0f, false },
+    { "ref-block37", "Reference, odd block size",                  "ref",      VERIFY_BITEXACT, true,  MAKO_TANH_EXACT,     37,   0, 0.0f, false },
+    { "exact",      "Block engine, tanhf",                         "ref",      -80.0f,          false, MAKO_TANH_EXACT,     512,  0, 0.0f, false },
+    { "rational",   "Block engine, rational tanh",                 "ref",      -80.0f,          false, MAKO_TANH_RATIONAL,  512,  0, 0.0f, false },
+    { "piecewise",  "Block engine, piecewise tanh",                "ref",      -80.0f,          false, MAKO_TANH_PIECEWISE, 512,  0, 0.0f, false },
+    { "clamped",    "Block engine, clamped Pade tanh",             "ref",      -24.0f,          false, MAKO_TANH_CLAMPED,   512,  0, 0.0f, false },
+    { "engine",     "Block engine, default tanh (MAKO_TANH_TIER)", "ref",      -80.0f,          false, MAKO_TANH_TIER,      512,  0, 0.0f, false },
+    { "block16",    "Default engine, 16 sample blocks",            "engine",   -150.0f,         false, MAKO_TANH_TIER,      16,   0, 0.0f, false },
+    { "block37",    "Default engine, odd block size",              "engine",   -150.0f,         false, MAKO_TANH_TIER,      37,   0, 0.0f, false },
+    { "block4096",  "Default engine, blocks over the chunk size",  "engine",   -150.0f,         false, MAKO_TANH_TIER,      4096, 0, 0.0f, false },
+    { "mono",       "Default engine, one mono instance per side",  "engine",   -150.0f,         false, MAKO_TANH_TIER,      512,  0, 0.0f, true },
+    { "os2x",       "2x oversampling",                             "ref",      -18.0f,          false, MAKO_TANH_TIER,      512,  1, 0.0f, false, MAKO_ADAA_OFF, true },
+    { "os2x-block37", "2x oversampling, odd block size",           "os2x",     -150.0f,         false, MAKO_TANH_TIER,      37,   1, 0.0f, false },
+    { "os8x",       "8x oversampling",                             "ref",      -18.0f,          false, MAKO_TANH_TIER,      512,  3, 0.0f, false, MAKO_ADAA_OFF, true },
+    { "os8x-block37", "8x oversampling, odd block size",           "os8x",     -150.0f,         false, MAKO_TANH_TIER,      37,   3, 0.0f, false },
+    { "os8x-mono",  "8x oversampling, one mono instance per side", "os8x",     -150.0f,         false, MAKO_TANH_TIER,      512,  3, 0.0f, true },
+    { "internal",   "Internal rate mode at half the test rate",    "ref",      -12.0f,          false, MAKO_TANH_TIER,      512,  0, -.5f, false, MAKO_ADAA_OFF, true },
+    { "internal-block37", "Internal rate mode, odd block size",    "internal", -150.0f,         false, MAKO_TANH_TIER,      37,   0, -.5f, false },
+    { "internal-mono", "Internal rate mode, one mono instance per side", "internal", -150.0f,         false, MAKO_TANH_TIER, 512, 0, -.5f, true },
+    { "adaa1",      "1st order ADAA shapers",                      "ref",      -16.0f,          false, MAKO_TANH_TIER,      512,  0, 0.0f, false, MAKO_ADAA_1ST, true, 1.5f },
+    { "adaa1-block37", "1st order ADAA, odd block size",           "adaa1",    -150.0f,         false, MAKO_TANH_TIER,      37,   0, 0.0f, false, MAKO_ADAA_1ST },
+    { "adaa2",      "2nd order ADAA shapers",                      "ref",      -12.0f,          false, MAKO_TANH_TIER,      512,  0, 0.0f, false, MAKO_ADAA_2ND, true, 3.0f },
+    { "adaa2-block37", "2nd order ADAA, odd block size",           "adaa2",    -150.0f,         false, MAKO_TANH_TIER,      37,   0, 0.0f, false, MAKO_ADAA_2ND },
+    { "adaa2-mono", "2nd order ADAA, one mono instance per side",  "adaa2",    -150.0f,         false, MAKO_TANH_TIER,      512,  0, 0.0f, true,  MAKO_ADAA_2ND },
+};
+const int VERIFY_PATHS = int(sizeof(Verify_Paths) / sizeof(Verify_Paths[0]));
+
+static int Verify_Find(const char* name)
+{
+    for (int p = 0; p < VERIFY_PATHS; p++)
+        if (juce::String(Verify_Paths[p].Name) == juce::String(name)) return p;
+    return -1;
+}
+
+//R1.01 The settings every signal is run with.
+static const char* Verify_SettingNames[] = { "default", "all", "hot" };
+static const char* Verify_Settings[][8] = {
+    { nullptr },
+    { "ngate=.3", "drive=.7", "enhhigh=.5", "enhlow=.5", "mix=.8", nullptr },
+    { "gain=2", "drive=1", "high=1800", "enhhigh=1", nullptr },
+};
+const int VERIFY_SETTINGS = 3;
+
+static const char* Verify_SignalNames[] = { "sweep", "impulse", "noise", "di" };
+const int VERIFY_SIGNALS = 4;
+
+//R1.01 Fill a stereo test signal. The right channel is the left one at a different level
+//R1.01 (or a different seed), so both lanes carry their own audio.
+static void Verify_MakeSignal(int sig, juce::AudioBuffer<float>& source, double rate)
+{
+    const double Pi = 3.14159265358979;
+    const int len = source.getNumSamples();
+    for (int ch = 0; ch < source.getNumChannels(); ch++)
+    {
+        float* data = source.getWritePointer(ch);
+        const float level = (ch == 0) ? .5f : .3f;
+        juce::Random rnd(1000 + ch);
+        for (int t = 0; t < len; t++)
+        {
+            double pos = double(t) / rate;
+            switch (sig)
+            {
+            case 0: //R1.01 Log sweep 20 Hz to 20 kHz over the whole signal.
+            {
+                double k = std::log(1000.0) / (double(len) / rate);
+                data[t] = level * float(std::sin(2.0 * Pi * 20.0 * (std::exp(k * pos) - 1.0) / k));
+                break;
+            }
+            case 1: //R1.01 A full scale click every .25 s, offset per channel. Silence between lets the gate close.
+                data[t] = ((t % int(rate * .25)) == ch * 11) ? 1.0f : 0.0f;
+                break;
+            case 2:
+                data[t] = level * (rnd.nextFloat() * 2.0f - 1.0f);
+                break;
+            default: //R1.01 Plucked notes with a little hum and noise, like a guitar DI.
+            {
+                const int noteLen = int(rate * .25);
+                int note = t / noteLen;
+                double np = double(t % noteLen) / rate;
+                double freq = 82.41 * std::pow(2.0, double((note * 7 + ch * 3) % 29) / 12.0);
+                double env = std::exp(-np * 9.0) * (1.0 - std::exp(-np * 2000.0));
+                double pluck = std::sin(2.0 * Pi * freq * np) + .5 * std::sin(4.0 * Pi * freq * np) + .25 * std::sin(6.0 * Pi * freq * np);
+                data[t] = level * float(env * pluck) + .002f * float(std::sin(2.0 * Pi * 60.0 * pos)) + (rnd.nextFloat() - .5f) * .001f;
+                break;
+            }
+            }
+        }
+    }
+}
+
+//R1.01 Run source thru one path. The latency is removed so the result lines up with the input.
+//R1.01 False if the path's settings are not valid, error says why.
+static bool Verify_Render(const tp_verify_path& vp, int setting, const juce::AudioBuffer<float>& source, double rate, juce::AudioBuffer<float>& result, juce::String& error)
+{
+    const int numChannels = source.getNumChannels();
+    const int len = source.getNumSamples();
+    result.setSize(numChannels, len);
+
+    const int runs = vp.Mono ? numChannels : 1;
+    const int runChannels = vp.Mono ? 1 : numChannels;
+    for (int run = 0; run < runs; run++)
+    {
+        MakoBiteAudioProcessor proc;
+        proc.Engine_UseScalarReference = vp.Reference;
+        proc.Tanh_Tier = vp.Tanh;
+        proc.Engine_InternalRate = (vp.InternalRate < 0.0f) ? float(rate) * -vp.InternalRate : vp.InternalRate;
+        MakoTool_SetChannels(proc, runChannels);
+
+        juce::StringArray params;
+        for (int t = 0; Verify_Settings[setting][t] != nullptr; t++) params.add(Verify_Settings[setting][t]);
+        params.add("quality=" + juce::String(vp.Quality));
+        params.add("shaper=" + juce::String(vp.Shaper));
+        if (! MakoTool_ApplySettings(proc, juce::File(), params, error)) return false;
+
+        proc.setNonRealtime(false);
+        proc.setRateAndBufferSizeDetails(rate, vp.Block);
+        proc.prepareToPlay(rate, vp.Block);
+
+        //R1.01 Feed silence after the end to flush out the latency.
+        const int latency = proc.getLatencySamples();
+        juce::AudioBuffer<float> buffer(runChannels, vp.Block);
+        juce::MidiBuffer midi;
+        for (int pos = 0; pos < len + latency; pos += vp.Block)
+        {
+            const int num = juce::jmin(vp.Block, len + latency - pos);
+            buffer.setSize(runChannels, num, false, false, true);
+            buffer.clear();
+            for (int ch = 0; ch < runChannels; ch++)
+                if (pos < len) buffer.copyFrom(ch, 0, source, run + ch, pos, juce::jmin(num, len - pos));
+            proc.processBlock(buffer, midi);
+
+            for (int ch = 0; ch < runChannels; ch++)
+            {
+                const float* out = buffer.getReadPointer(ch);
+                for (int t = 0; t < num; t++)
+                {
+                    int dst = pos + t - latency;
+                    if ((0 <= dst) && (dst < len)) result.setSample(run + ch, dst, out[t]);
+                }
+            }
+        }
+        proc.releaseResources();
+    }
+    return true;
+}
+
+//R1.01 Plain in place radix 2 FFT. Only used here, speed does not matter.
+static void Verify_FFT(std::vector<std::complex<double>>& x)
+{
+    const size_t n = x.size();
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(x[i], x[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        std::complex<double> w = std::polar(1.0, -2.0 * 3.14159265358979 / double(len));
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> wk(1.0, 0.0);
+            for (size_t k = 0; k < len / 2; k++)
+            {
+                std::complex<double> a = x[i + k];
+                std::complex<double> b = x[i + k + len / 2] * wk;
+                x[i + k] = a + b;
+                x[i + k + len / 2] = a - b;
+                wk *= w;
+            }
+        }
+    }
+}
+
+static void Verify_Frame(const juce::AudioBuffer<float>& buf, int ch, int start, std::vector<std::complex<double>>& frame)
+{
+    for (int t = 0; t < VERIFY_FFT; t++)
+    {
+        double win = .5 - .5 * std::cos(2.0 * 3.14159265358979 * double(t) / double(VERIFY_FFT));
+        frame[size_t(t)] = std::complex<double>(buf.getSample(ch, start + t) * win, 0.0);
+    }
+    Verify_FFT(frame);
+}
+
+//R1.01 Power per FFT bin, averaged over every frame of every channel.
+//R1.01 With minus it is the power of buf - minus, minus delayed by delay samples first (a phase shift per bin).
+static std::vector<double> Verify_Spectrum(const juce::AudioBuffer<float>& buf, const juce::AudioBuffer<float>* minus, double delay = 0.0)
+{
+    std::vector<double> power(VERIFY_FFT / 2 + 1, 0.0);
+    std::vector<std::complex<double>> frame(VERIFY_FFT), sub(VERIFY_FFT);
+    for (int ch = 0; ch < buf.getNumChannels(); ch++)
+    for (int start = 0; start + VERIFY_FFT <= buf.getNumSamples(); start += VERIFY_FFT / 2)
+    {
+        if ((minus != nullptr) && (delay == 0.0))
+        {
+            //R1.01 No delay, subtract before the FFT so near identical paths keep every bit.
+            for (int t = 0; t < VERIFY_FFT; t++)
+            {
+                double win = .5 - .5 * std::cos(2.0 * 3.14159265358979 * double(t) / double(VERIFY_FFT));
+                frame[size_t(t)] = std::complex<double>((double(buf.getSample(ch, start + t)) - minus->getSample(ch, start + t)) * win, 0.0);
+            }
+            Verify_FFT(frame);
+        }
+        else
+        {
+            Verify_Frame(buf, ch, start, frame);
+            if (minus != nullptr)
+            {
+                Verify_Frame(*minus, ch, start, sub);
+                for (size_t b = 0; b < power.size(); b++)
+                    frame[b] -= sub[b] * std::polar(1.0, -2.0 * 3.14159265358979 * double(b) * delay / double(VERIFY_FFT));
+            }
+        }
+        for (size_t b = 0; b < power.size(); b++) power[b] += std::norm(frame[b]);
+    }
+    return power;
+}
+
+//R1.01 The delay of test against ref, 0 to maxDelay samples, that leaves the least error under VERIFY_INBAND.
+//R1.01 |T - R e^-jwd|^2 = |T|^2 + |R|^2 - 2 Re(T conj(R) e^jwd), so the cross spectrum is summed once
+//R1.01 and every step of the search is only a pass over the bins.
+static double Verify_Delay(const juce::AudioBuffer<float>& ref, const juce::AudioBuffer<float>& test, double rate, double maxDelay)
+{
+    const size_t bins = juce::jmin(size_t(VERIFY_FFT / 2 + 1), size_t(VERIFY_INBAND * VERIFY_FFT / rate) + 1);
+    std::vector<std::complex<double>> cross(bins), r(VERIFY_FFT), t(VERIFY_FFT);
+    for (int ch = 0; ch < ref.getNumChannels(); ch++)
+    for (int start = 0; start + VERIFY_FFT <= ref.getNumSamples(); start += VERIFY_FFT / 2)
+    {
+        Verify_Frame(ref, ch, start, r);
+        Verify_Frame(test, ch, start, t);
+        for (size_t b = 1; b < bins; b++) cross[b] += t[b] * std::conj(r[b]);
+    }
+
+    double best = 0.0, bestMatch = 0.0;
+    for (double d = 0.0; d <= maxDelay + 1e-9; d += VERIFY_DELAYSTEP)
+    {
+        double match = 0.0;
+        for (size_t b = 1; b < bins; b++)
+            match += (cross[b] * std::polar(1.0, 2.0 * 3.14159265358979 * double(b) * d / double(VERIFY_FFT))).real();
+        if ((d == 0.0) || (bestMatch < match))
+        {
+            bestMatch = match;
+            best = d;
+        }
+    }
+    return best;
+}
+
+static double Verify_Db(double ratio) { return (ratio <= 0.0) ? -999.0 : 20.0 * std::log10(ratio); }
+
+//R1.01 What one path did on one signal.
+struct tp_verify_result {
+    bool BitExact = true;
+    double PeakDb = -999.0;
+    double RmsDb = -999.0;
+    double SpecDb = -999.0;
+    double SpecHz = 0.0;        //R1.01 Center of the worst band.
+    double BandDb = -999.0;     //R1.01 Error power under VERIFY_INBAND, dB relative to the reference there.
+    double Delay = 0.0;         //R1.01 Samples the reference was delayed by for BandDb and SpecDb.
+};
+
+static tp_verify_result Verify_Compare(const juce::AudioBuffer<float>& ref, const juce::AudioBuffer<float>& test, double rate, double maxDelay)
+{
+    tp_verify_result vr;
+    double refPeak = 0.0, refSum = 0.0, errPeak = 0.0, errSum = 0.0;
+    for (int ch = 0; ch < ref.getNumChannels(); ch++)
+    for (int t = 0; t < ref.getNumSamples(); t++)
+    {
+        double r = ref.getSample(ch, t);
+        double e = double(test.getSample(ch, t)) - r;
+        if (ref.getSample(ch, t) != test.getSample(ch, t)) vr.BitExact = false;
+        refPeak = juce::jmax(refPeak, std::abs(r));
+        errPeak = juce::jmax(errPeak, std::abs(e));
+        refSum += r * r;
+        errSum += e * e;
+    }
+    if (vr.BitExact) return vr;
+
+    vr.PeakDb = Verify_Db(errPeak / juce::jmax(1e-12, refPeak));
+    vr.RmsDb = Verify_Db(std::sqrt(errSum / juce::jmax(1e-24, refSum)));
+
+    //R1.01 Octave bands. Bands where the reference is more than 100 dB under its loudest band are
+    //R1.01 skipped, there is nothing there to compare (e.g. the gated silence of the impulse signal).
+    if (0.0 < maxDelay) vr.Delay = Verify_Delay(ref, test, rate, maxDelay);
+    std::vector<double> refPow = Verify_Spectrum(ref, nullptr);
+    std::vector<double> errPow = Verify_Spectrum(test, &ref, vr.Delay);
+    const double binHz = rate / double(VERIFY_FFT);
+    double inRef = 0.0, inErr = 0.0;
+    for (size_t b = 1; (b < refPow.size()) && (double(b) * binHz < VERIFY_INBAND); b++)
+    {
+        inRef += refPow[b];
+        inErr += errPow[b];
+    }
+    vr.BandDb = 10.0 * std::log10(juce::jmax(1e-30, inErr / juce::jmax(1e-30, inRef)));
+    double bandRef[10] = {}, bandErr[10] = {}, loudest = 0.0;
+    for (int band = 0; band < 10; band++)
+    {
+        double lo = 31.25 * std::pow(2.0, band) / std::sqrt(2.0);
+        double hi = lo * 2.0;
+        for (size_t b = 1; b < refPow.size(); b++)
+        {
+            double hz = double(b) * binHz;
+            if ((hz < lo) || (hi <= hz)) continue;
+            bandRef[band] += refPow[b];
+            bandErr[band] += errPow[b];
+        }
+        loudest = juce::jmax(loudest, bandRef[band]);
+    }
+    for (int band = 0; band < 10; band++)
+    {
+        if ((bandRef[band] <= 0.0) || (bandRef[band] < loudest * 1e-10)) continue;
+        double db = 10.0 * std::log10(juce::jmax(1e-30, bandErr[band] / bandRef[band]));
+        if (vr.SpecHz == 0.0 || vr.SpecDb < db)
+        {
+            vr.SpecDb = db;
+            vr.SpecHz = 31.25 * std::pow(2.0, band);
+        }
+    }
+    return vr;
+}
+
+static bool Verify_Pass(const tp_verify_path& vp, const tp_verify_result& vr)
+{
+    if (vp.TolDb <= VERIFY_BITEXACT) return vr.BitExact;
+    return vr.BitExact || ((vp.InBand ? vr.BandDb : vr.RmsDb) <= double(vp.TolDb));
+}
+
+static juce::String Verify_Tol(const tp_verify_path& vp)
+{
+    if (vp.TolDb <= VERIFY_BITEXACT) return "exact";
+    return juce::String(vp.TolDb, 0) + (vp.InBand ? " band" : "");
+}
+
+//R1.01 One result row, on the console and in the CSV.
+static void Verify_Print(const char* name, const char* against, int sig, int set, const juce::String& tol, const tp_verify_result& vr, bool pass, std::ofstream& csv)
+{
+    juce::String peak = vr.BitExact ? "exact" : juce::String(vr.PeakDb, 1);
+    juce::String rms = vr.BitExact ? "" : juce::String(vr.RmsDb, 1);
+    juce::String band = vr.BitExact ? "" : juce::String(vr.BandDb, 1);
+    juce::String delay = (vr.Delay == 0.0) ? "" : juce::String(vr.Delay, 2);
+    juce::String spec = vr.BitExact ? "" : juce::String(vr.SpecDb, 1) + " @ " + juce::String(juce::roundToInt(vr.SpecHz));
+    std::cout << juce::String(name).paddedRight(' ', 18) << juce::String(against).paddedRight(' ', 10)
+              << juce::String(Verify_SignalNames[sig]).paddedRight(' ', 9) << juce::String(Verify_SettingNames[set]).paddedRight(' ', 9)
+              << tol.paddedRight(' ', 10) << peak.paddedRight(' ', 9) << rms.paddedRight(' ', 9) << band.paddedRight(' ', 9) << delay.paddedRight(' ', 7) << spec
+              << (pass ? "" : "  FAIL") << std::endl;
+
+    if (csv.is_open())
+        csv << name << "," << against << "," << Verify_SignalNames[sig] << "," << Verify_SettingNames[set] << "," << tol
+            << "," << (vr.BitExact ? 1 : 0) << "," << juce::String(vr.PeakDb, 2) << "," << juce::String(vr.RmsDb, 2) << "," << juce::String(vr.BandDb, 2)
+            << "," << juce::String(vr.Delay, 2) << "," << juce::String(vr.SpecDb, 2) << "," << juce::roundToInt(vr.SpecHz) << "," << (pass ? 1 : 0) << std::endl;
+}
+
+//R1.01 Stored render of one path: the rate, then each channel's samples in turn.
+static juce::File Verify_GoldenFile(const juce::File& dir, const tp_verify_path& vp, int sig, int set)
+{
+    return dir.getChildFile(juce::String(vp.Name) + "_" + Verify_SignalNames[sig] + "_" + Verify_SettingNames[set] + ".f32");
+}
+
+static bool Verify_WriteGolden(const juce::File& file, const juce::AudioBuffer<float>& buf, double rate)
+{
+    juce::MemoryBlock data;
+    data.append(&rate, sizeof(rate));
+    for (int ch = 0; ch < buf.getNumChannels(); ch++)
+        data.append(buf.getReadPointer(ch), sizeof(float) * size_t(buf.getNumSamples()));
+    return file.replaceWithData(data.getData(), data.getSize());
+}
+
+//R1.01 False if the file is missing or was made with another --rate or --seconds.
+static bool Verify_ReadGolden(const juce::File& file, juce::AudioBuffer<float>& buf, int numChannels, int len, double rate)
+{
+    juce::MemoryBlock data;
+    if (! file.loadFileAsData(data)) return false;
+    if (data.getSize() != sizeof(double) + sizeof(float) * size_t(numChannels) * size_t(len)) return false;
+    const char* bytes = static_cast<const char*>(data.getData());
+    double fileRate;
+    std::memcpy(&fileRate, bytes, sizeof(fileRate));
+    if (fileRate != rate) return false;
+    buf.setSize(numChannels, len);
+    for (int ch = 0; ch < numChannels; ch++)
+        std::memcpy(buf.getWritePointer(ch), bytes + sizeof(double) + sizeof(float) * size_t(ch) * size_t(len), sizeof(float) * size_t(len));
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+#if MAKO_RTAUDIT
+    MakoAudit::Get().Warm();
+#endif
+
+    double rate = 48000.0;
+    double seconds = 2.0;
+    juce::StringArray only;
+    juce::File csvFile;
+    juce::File goldenDir;
+    bool writeGolden = false;
+
+    for (int t = 1; t < argc; t++)
+    {
+        juce::String arg(argv[t]);
+        bool hasValue = (t + 1 < argc);
+        if (arg == "--rate" && hasValue)            rate = juce::jmax(8000.0, juce::String(argv[++t]).getDoubleValue());
+        else if (arg == "--seconds" && hasValue)    seconds = juce::jmax(.25, juce::String(argv[++t]).getDoubleValue());
+        else if (arg == "--path" && hasValue)       only.add(argv[++t]);
+        else if (arg == "--csv" && hasValue)        csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--golden" && hasValue)     goldenDir = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+        else if (arg == "--write-golden" && hasValue)
+        {
+            goldenDir = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++t]);
+            writeGolden = true;
+        }
+        else if (arg == "--list")
+        {
+            for (int p = 0; p < VERIFY_PATHS; p++)
+                std::cout << juce::String(Verify_Paths[p].Name).paddedRight(' ', 18) << Verify_Tol(Verify_Paths[p]).paddedRight(' ', 10)
+                          << Verify_Paths[p].About << std::endl;
+            return 0;
+        }
+        else
+        {
+            std::cerr << "MakoOD_Verify [--rate hz] [--seconds n] [--path name ...] [--csv file] [--golden dir | --write-golden dir] [--list]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream csv;
+    if (csvFile != juce::File())
+    {
+        csv.open(csvFile.getFullPathName().toRawUTF8());
+        if (! csv)
+        {
+            std::cerr << "Can not write " << csvFile.getFullPathName() << std::endl;
+            return 1;
+        }
+        csv << "path,against,signal,setting,tolerance,bitexact,peak_db,rms_db,band_db,delay,spec_db,spec_hz,pass" << std::endl;
+    }
+
+    std::cout << "path              against   signal   setting  tol       peak_db  rms_db   band_db  delay  spec_db @ Hz" << std::endl;
+    //R1.01 A path that is asked for also needs the path it is checked against.
+    bool want[VERIFY_PATHS] = {};
+    for (int p = VERIFY_PATHS - 1; 0 <= p; p--)
+    {
+        if ((only.size() == 0) || only.contains(Verify_Paths[p].Name)) want[p] = true;
+        if (want[p] && (Verify_Paths[p].Against != nullptr)) want[Verify_Find(Verify_Paths[p].Against)] = true;
+    }
+
+    int failed = 0;
+    const int len = int(rate * seconds);
+    for (int sig = 0; sig < VERIFY_SIGNALS; sig++)
+    {
+        juce::AudioBuffer<float> source(2, len);
+        Verify_MakeSignal(sig, source, rate);
+
+        for (int set = 0; set < VERIFY_SETTINGS; set++)
+        {
+            std::vector<juce::AudioBuffer<float>> result(VERIFY_PATHS);
+            for (int p = 0; p < VERIFY_PATHS; p++)
+            {
+                const tp_verify_path& vp = Verify_Paths[p];
+                if (! want[p]) continue;
+                juce::String error;
+                if (! Verify_Render(vp, set, source, rate, result[size_t(p)], error))
+                {
+                    std::cerr << vp.Name << ", " << Verify_SettingNames[set] << ": " << error << std::endl;
+                    return 1;
+                }
+                if (vp.Against == nullptr) continue;
+
+                tp_verify_result vr = Verify_Compare(result[size_t(Verify_Find(vp.Against))], result[size_t(p)], rate, vp.MaxDelay);
+                bool pass = Verify_Pass(vp, vr);
+                if (! pass) failed++;
+                Verify_Print(vp.Name, vp.Against, sig, set, Verify_Tol(vp), vr, pass, csv);
+
+                //R1.01 The sound changing paths against their own stored render.
+                if (! vp.InBand || (goldenDir == juce::File())) continue;
+                juce::File file = Verify_GoldenFile(goldenDir, vp, sig, set);
+                if (writeGolden)
+                {
+                    if (! Verify_WriteGolden(file, result[size_t(p)], rate))
+                    {
+                        std::cerr << "Can not write " << file.getFullPathName() << std::endl;
+                        return 1;
+                    }
+                    continue;
+                }
+                juce::AudioBuffer<float> golden;
+                if (! Verify_ReadGolden(file, golden, source.getNumChannels(), len, rate))
+                {
+                    std::cerr << "Can not read " << file.getFullPathName() << ", or it was saved with another --rate or --seconds" << std::endl;
+                    return 1;
+                }
+                vr = Verify_Compare(golden, result[size_t(p)], rate, 0.0);
+                pass = vr.BitExact || (vr.RmsDb <= double(VERIFY_GOLDEN));
+                if (! pass) failed++;
+                Verify_Print(vp.Name, "golden", sig, set, juce::String(VERIFY_GOLDEN, 0), vr, pass, csv);
+            }
+        }
+    }
+
+    if (0 < failed) std::cout << failed << " results outside tolerance." << std::endl;
+    else std::cout << "All paths within tolerance." << std::endl;
+
+#if MAKO_RTAUDIT
+    std::cout << std::flush;
+    MakoAudit::Get().Report(stdout, true);
+    std::fflush(stdout);
+    if (0 < MakoAudit::Get().Violations()) return 1;
+#endif
+    return (0 < failed) ? 1 : 0;
+}